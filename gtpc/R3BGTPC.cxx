@@ -16,6 +16,7 @@
 #include "FairRuntimeDb.h"
 #include "FairVolume.h"
 #include "R3BGTPCPoint.h"
+#include "R3BGTPCStringTable.h"
 #include "R3BMCStack.h"
 #include "TClonesArray.h"
 #include "TGeoMCGeometry.h"
@@ -55,6 +56,11 @@ R3BGTPC::R3BGTPC(const TString& geoFile, const TGeoTranslation& trans, const TGe
 
 R3BGTPC::R3BGTPC(const TString& geoFile, const TGeoCombiTrans& combi)
     : R3BDetector("R3BGTPC", kGTPC, geoFile, combi)
+    , fPointsPersistence(kTRUE)
+    , fStringTable(kFALSE)
+    , fMaxSegmentLength(0)
+    , fMaxSegmentELoss(0)
+    , fOpenPoint(-1)
 {
     fGTPCPointCollection = new TClonesArray("R3BGTPCPoint");
 }
@@ -70,7 +76,15 @@ R3BGTPC::~R3BGTPC()
 }
 // -------------------------------------------------------------------------
 
-void R3BGTPC::FinishRun() { ; }
+void R3BGTPC::FinishRun()
+{
+    if (fStringTable)
+    {
+        R3BGTPCStringTable* table = R3BGTPCStringTable::Instance();
+        LOG(info) << "R3BGTPC: writing the " << table->GetSize() << " names of the points";
+        FairRootManager::Instance()->GetSink()->WriteObject(table, R3BGTPCStringTable::kKeyName, TObject::kOverwrite);
+    }
+}
 
 // -------------------------------------------------------------------------
 void R3BGTPC::Initialize()
@@ -80,6 +94,18 @@ void R3BGTPC::Initialize()
     LOG(debug) << "-I- R3BGTPC: Vol (McId) def";
     LOG(info) << "R3BGTPC: GTPC_box Vol. (McId) " << gMC->VolId("GTPC_box");
     LOG(info) << "R3BGTPC: Active_region Vol. (McId) " << gMC->VolId("Active_region");
+
+    if (fStringTable)
+    { // new run, new table
+        LOG(info) << "R3BGTPC: names of the points stored in R3BGTPCStringTable";
+        R3BGTPCStringTable::Instance()->Clear();
+        fParticleNameIds.clear();
+        fVolNameIds.clear();
+        fProcessNameIds.assign(kMaxMCProcess, -2);
+    }
+    if (fMaxSegmentLength > 0 || fMaxSegmentELoss > 0)
+        LOG(info) << "R3BGTPC: steps inside the gas condensed up to " << fMaxSegmentLength << " cm and "
+                  << fMaxSegmentELoss << " GeV per point";
 }
 
 //____________________________________________________________
@@ -141,15 +167,47 @@ Bool_t R3BGTPC::ProcessHits(FairVolume* vol)
                                           gMC->IsTrackInside(),
                                           gMC->IsTrackOut());
 
+    Int_t trackID = gMC->GetStack()->GetCurrentTrackNumber();
+    if (gMC->TrackPid() != 0 && CondenseStep(trackID, theTrackStatus, pos, mom))
+        return kTRUE;
+
     Int_t parentTrackID = gMC->GetStack()->GetCurrentParentTrackNumber();
-    TString particleName = gMC->GetStack()->GetCurrentTrack()->GetName();
     //_______________only care about primary particle
     // if (parentTrackID == -1 || (parentTrackID == 0 && particleName != "e-"))
     if (gMC->TrackPid() != 0) // due to the INCL generator
     {
+        // string-table mode: the names are looked up once per particle, volume and process
+        TString particleName, volName, processName;
+        Short_t particleNameId = -1, volNameId = -1, processNameId = -1;
+        TMCProcess process = gMC->ProdProcess(0);
+        if (fStringTable)
+        {
+            R3BGTPCStringTable* table = R3BGTPCStringTable::Instance();
+            auto particle = fParticleNameIds.find(gMC->TrackPid());
+            if (particle == fParticleNameIds.end())
+                particle = fParticleNameIds
+                               .emplace(gMC->TrackPid(), table->GetId(gMC->GetStack()->GetCurrentTrack()->GetName()))
+                               .first;
+            particleNameId = particle->second;
+            auto volume = fVolNameIds.find(vol);
+            if (volume == fVolNameIds.end())
+                volume = fVolNameIds.emplace(vol, table->GetId(vol->GetName())).first;
+            volNameId = volume->second;
+            if (fProcessNameIds[process] == -2)
+                fProcessNameIds[process] = table->GetId(TMCProcessName[process]);
+            processNameId = fProcessNameIds[process];
+        }
+        // the names not in the table (not in string-table mode, or table full) are kept in the point
+        if (particleNameId < 0)
+            particleName = gMC->GetStack()->GetCurrentTrack()->GetName();
+        if (volNameId < 0)
+            volName = vol->GetName();
+        if (processNameId < 0)
+            processName = TMCProcessName[process];
+
         Int_t size = fGTPCPointCollection->GetEntriesFast();
-        new ((*fGTPCPointCollection)[size])
-            R3BGTPCPoint(gMC->GetStack()->GetCurrentTrackNumber(), // trackID
+        R3BGTPCPoint* point = new ((*fGTPCPointCollection)[size])
+            R3BGTPCPoint(trackID,                                  // trackID
                          vol->getModId(),                          // check if getModId or CurrentVolOffID(1,modID)
                          pos.Vect(),                               // pos from gMC->TrackPosition(pos);
                          mom.Vect(),                               // mom from gMC->TrackMomentum(pos);
@@ -164,13 +222,27 @@ Bool_t R3BGTPC::ProcessHits(FairVolume* vol)
                          vol->getModId(),                                  // moduleID
                          vol->getCopyNo(),                                 // detCopyID
                          particleName,                                     // particleName
-                         vol->GetName(),                                   // volName (or vol->getRealName();??)
-                         TMCProcessName[gMC->ProdProcess(0)],              // processName
+                         volName,                                          // volName (or vol->getRealName();??)
+                         processName,                                      // processName
                          gMC->TrackCharge(),                               // charge
                          gMC->TrackMass(),                 // Return the mass of the track currently transported.
                          (gMC->Etot() - gMC->TrackMass()), // kineticEnergy
                          gMC->TrackStep(), // Return the length in centimeters of the current step (in cm)
                          kTRUE);           // isAccepted
+        point->SetNameIds(particleNameId, volNameId, processNameId);
+
+        // a step inside the gas opens a point that the next steps of the track can extend
+        if (theTrackStatus == kStatusInside && (fMaxSegmentLength > 0 || fMaxSegmentELoss > 0))
+        {
+            R3BGTPCPoint* previous = size > 0 ? (R3BGTPCPoint*)fGTPCPointCollection->At(size - 1) : nullptr;
+            fOpenPoint = size;
+            if (previous && previous->GetTrackID() == trackID)
+                fSegmentStart.SetXYZ(previous->GetX(), previous->GetY(), previous->GetZ());
+            else
+                fSegmentStart = pos.Vect();
+        }
+        else
+            fOpenPoint = -1;
     }
 
     // Increment number of LandPoints for this track
@@ -180,6 +252,31 @@ Bool_t R3BGTPC::ProcessHits(FairVolume* vol)
     return kTRUE;
 }
 
+Bool_t R3BGTPC::CondenseStep(Int_t trackID, Int_t trackStatus, const TLorentzVector& pos, const TLorentzVector& mom)
+{
+    // only steps inside the gas are merged: the points entering, exiting or changing the status are
+    // kept, as R3BGTPCLangevin and R3BGTPCProjector build the track segments from them
+    if (fOpenPoint < 0 || trackStatus != kStatusInside || fOpenPoint != fGTPCPointCollection->GetEntriesFast() - 1)
+        return kFALSE;
+    R3BGTPCPoint* point = (R3BGTPCPoint*)fGTPCPointCollection->At(fOpenPoint);
+    if (point->GetTrackID() != trackID)
+        return kFALSE;
+    Double_t eLoss = point->GetEnergyLoss() + gMC->Edep();
+    if ((fMaxSegmentLength > 0 && (pos.Vect() - fSegmentStart).Mag() > fMaxSegmentLength) ||
+        (fMaxSegmentELoss > 0 && eLoss > fMaxSegmentELoss))
+        return kFALSE;
+
+    // the point moves to the end of the step, with the energy deposited along the whole segment
+    point->SetPosition(pos.Vect());
+    point->SetMomentum(mom.Vect());
+    point->SetTime(gMC->TrackTime());
+    point->SetLength(gMC->TrackLength());
+    point->SetEnergyLoss(eLoss);
+    point->SetKineticEnergy(gMC->Etot() - gMC->TrackMass());
+    point->SetTrackStep(point->GetTrackStep() + gMC->TrackStep());
+    return kTRUE;
+}
+
 // ----    Public method BeginOfEvent   -----------------------------------------
 void R3BGTPC::BeginEvent() { ; }
 
@@ -193,7 +290,10 @@ void R3BGTPC::EndOfEvent()
 // ----------------------------------------------------------------------------
 
 // -----   Public method Register   -------------------------------------------
-void R3BGTPC::Register() { FairRootManager::Instance()->Register("GTPCPoint", GetName(), fGTPCPointCollection, kTRUE); }
+void R3BGTPC::Register()
+{
+    FairRootManager::Instance()->Register("GTPCPoint", GetName(), fGTPCPointCollection, fPointsPersistence);
+}
 // ----------------------------------------------------------------------------
 
 // -----   Public method GetCollection   --------------------------------------
@@ -216,7 +316,11 @@ void R3BGTPC::Print(Option_t* option) const
 // ----------------------------------------------------------------------------
 
 // -----   Public method Reset   ----------------------------------------------
-void R3BGTPC::Reset() { fGTPCPointCollection->Clear(); }
+void R3BGTPC::Reset()
+{
+    fGTPCPointCollection->Clear();
+    fOpenPoint = -1;
+}
 
 //_________________________________________________________
 Bool_t R3BGTPC::CheckIfSensitive(std::string name)
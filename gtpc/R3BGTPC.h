@@ -16,6 +16,9 @@
 #include "R3BDetector.h"
 #include "TLorentzVector.h"
 
+#include <unordered_map>
+#include <vector>
+
 class TClonesArray;
 class R3BGTPCPoint;
 class FairVolume;
@@ -93,10 +96,30 @@ class R3BGTPC : public R3BDetector
 
     virtual void FinishRun();
 
+    /** Whether the GTPCPoints are written to the output (default). Without it they only live during the
+     * event, for a digitization task (R3BGTPCProjector, R3BGTPCLangevin) added to the simulation run **/
+    void SetPointsPersistence(Bool_t persistence) { fPointsPersistence = persistence; }
+
+    /** String-table mode: the points keep ids of R3BGTPCStringTable instead of the particle, volume
+     * and process names, the table being written once per run to the output file **/
+    void SetStringTable(Bool_t stringTable = kTRUE) { fStringTable = stringTable; }
+
+    /** Step condensing: consecutive steps of a track inside the gas (status 10010) are merged into one point,
+     * closed when the segment from the previous point would exceed maxLength [cm] or its energy deposit
+     * maxELoss [GeV]. The entering, exiting and other status changes always give their own point. 0 disables
+     * a limit, both 0 (default) keep one point per step **/
+    void SetStepCondensing(Double_t maxLength, Double_t maxELoss)
+    {
+        fMaxSegmentLength = maxLength;
+        fMaxSegmentELoss = maxELoss;
+    }
+
     virtual Bool_t CheckIfSensitive(std::string name);
 
     virtual void SetSpecialPhysicsCuts();
 
+    static const Int_t kStatusInside = 10010; //!< GetTrackStatus of an alive track inside the volume
+
     Int_t GetTrackStatus(bool NewTrack,
                          bool TrackDisappeared,
                          bool TrackStop,
@@ -108,6 +131,18 @@ class R3BGTPC : public R3BDetector
 
   private:
     TClonesArray* fGTPCPointCollection;
+    Bool_t fPointsPersistence;                                  //!< GTPCPoint written to the output
+    Bool_t fStringTable;                                        //!< Names of the points as R3BGTPCStringTable ids
+    std::unordered_map<Int_t, Short_t> fParticleNameIds;        //!< Name id by PDG code
+    std::unordered_map<const FairVolume*, Short_t> fVolNameIds; //!< Name id by volume
+    std::vector<Short_t> fProcessNameIds;                       //!< Name id by TMCProcess, -2 if not looked up yet
+    Double_t fMaxSegmentLength;                                 //!< Longest condensed segment [cm], 0 for no limit
+    Double_t fMaxSegmentELoss;                                  //!< Largest condensed deposit [GeV], 0 for no limit
+    Int_t fOpenPoint;                                           //!< Point still accepting steps, -1 if none
+    TVector3 fSegmentStart;                                     //!< Start of the segment of the open point [cm]
+
+    /** Merges the current step into the open point if the limits allow it **/
+    Bool_t CondenseStep(Int_t trackID, Int_t trackStatus, const TLorentzVector& pos, const TLorentzVector& mom);
 
     // void WriteParameterFile();
 
@@ -19,19 +19,17 @@
 
 #include "R3BGTPC.h"
 #include "R3BGTPCCal2Hit.h"
-#include "R3BGladFieldMap.h"
 
 // R3BGTPCCal2Hit: Constructor
 R3BGTPCCal2Hit::R3BGTPCCal2Hit()
-    : PadCoordArr(boost::extents[5632][4][2])
-    , FairTask("R3B GTPC Cal to Hit")
+    : FairTask("R3B GTPC Cal to Hit")
     , fCalCA(NULL)
     , fHitCA(NULL)
     , fTPCMap(NULL)
     , fOnline(kFALSE)
     , fLangevinBack(kTRUE)
+    , fNumBuckets(0)
 {
-    fTPCMap = std::make_shared<R3BGTPCMap>();
 }
 
 R3BGTPCCal2Hit::~R3BGTPCCal2Hit()
@@ -93,6 +91,26 @@ void R3BGTPCCal2Hit::SetParameter()
     fDriftEField = fGTPCElecPar->GetDriftEField();     // [V/cm]
     fDriftTimeStep = fGTPCElecPar->GetDriftTimeStep(); // [ns]
     fTimeBinSize = fGTPCElecPar->GetTimeBinSize();     // [ns]
+
+    // Field sampled once over the drift volume, with 2 cm margin for the backward drift
+    FairRunAna* run = FairRunAna::Instance();
+    fFieldCache.Init(run ? run->GetField() : nullptr,
+                     fOffsetX - 2.,
+                     fOffsetX + 2 * fHalfSizeTPC_X + 2.,
+                     -fHalfSizeTPC_Y - 2.,
+                     fHalfSizeTPC_Y + 2.,
+                     fOffsetZ - 2.,
+                     fOffsetZ + 2 * fHalfSizeTPC_Z + 2.);
+    fDriftKernel.Init(
+        &fFieldCache, fDriftVelocity, fDriftEField, fTransDiff, fLongDiff, fDriftTimeStep, -fHalfSizeTPC_Y);
+    fDriftKernel.SetStepTolerance(fGTPCElecPar->GetDriftStepTolerance());
+
+    // Pad plane, generated once per detector type and shared with the other tasks
+    fTPCMap = R3BGTPCMapRegistry::Get(fDetectorType);
+
+    // back-drifted points computed with the previous parameters are not valid anymore
+    fBackIndex.clear();
+    fBackPoints.clear();
 }
 
 InitStatus R3BGTPCCal2Hit::Init()
@@ -127,8 +145,6 @@ InitStatus R3BGTPCCal2Hit::Init()
 
     SetParameter();
 
-    fTPCMap->GeneratePadPlane();
-
     return kSUCCESS;
 }
 
@@ -154,11 +170,6 @@ void R3BGTPCCal2Hit::Exec(Option_t* opt)
     }
 
     Double_t x = 0, y = 0, z = 0, lW = 0, ene = 0;
-    R3BGladFieldMap* gladField = (R3BGladFieldMap*)FairRunAna::Instance()->GetField(); // B Field
-    if (!gladField)
-    {
-        LOG(warn) << "No GladField";
-    }
 
     R3BGTPCCalData** calData;
     calData = new R3BGTPCCalData*[nCals];
@@ -167,14 +178,8 @@ void R3BGTPCCal2Hit::Exec(Option_t* opt)
     {
         calData[i] = (R3BGTPCCalData*)(fCalCA->At(i));
         UShort_t pad = calData[i]->GetPadId();
-        std::vector<UShort_t> adc_cal = calData[i]->GetADC();
 
         Double_t counts = 0;
-        Double_t time = 0;
-        Double_t cloudLong = 0; //step by step
-        Double_t cloudTransv = 0;
-        Double_t sigmaLong = 0; //aprox for the whole time of reconstruction
-        Double_t sigmaTransv = 0;
 
         //To store all the hit weighted mean variables
         Double_t pad_counts = 0;
@@ -183,157 +188,27 @@ void R3BGTPCCal2Hit::Exec(Option_t* opt)
         Double_t hitz = 0;
         Double_t hitlW = 0;
 
+        if (fBackIndex.empty() || calData[i]->GetNumBuckets() != fNumBuckets)
+            ResetBackPoints(calData[i]->GetNumBuckets());
 
-        for (auto iadc = 0; iadc < adc_cal.size(); iadc++)
+        // only the non-zero time buckets are stored
+        for (Int_t isample = 0; isample < calData[i]->GetNumSamples(); isample++)
         {
-            counts = adc_cal[iadc];
-            time = iadc; //[timeBuckets]
-
-            // Important to take only non zero values
-            if (counts == 0)
-            {
-                continue;
-            }
+            Int_t iadc = calData[i]->GetBucket(isample);
+            counts = calData[i]->GetSample(isample);
 
-            auto PadCenterCoord = fTPCMap->CalcPadCenter(pad);
-            // Invalid ID condition PadCenterCoord[0]=-9999 (Should be solved in R3BGTPCLangevin)
-            if (PadCenterCoord[0] < -9000)
+            const BackPoint* point = GetBackPoint(pad, iadc);
+            if (!point)
             {
                 LOG(warn)<<"R3BGTPCCal2Hit::Exec Invalid padID";
                 continue;
             }
 
-            z = PadCenterCoord[0] / 10.0; //[cm] (PadCenterCoord on mm)
-            x = PadCenterCoord[1] / 10.0;
-            y = -fHalfSizeTPC_Y; //Start at pad plane
-
-            x = x + fOffsetX; //[cm]
-            z = z + fOffsetZ; //[cm]
-            time = time * fTimeBinSize + 0.5 * fTimeBinSize; //[ns] moving from TimeBuckets to ns; adding the half of
-                                                             //the size of the bin to take the center of the bin
-
-            // Reconstruction without Langevin
-            if (fLangevinBack == kFALSE)
-            {
-                y = y + time * fDriftVelocity; // [cm] Simple projection case -> Same x,z just moving in coord y
-            }
-            // Reconstruction with Langevin
-            if (fLangevinBack == kTRUE)
-            {
-                Double_t accDriftTime = time; // Making a copy for loop discounting
-                Double_t E_x = 0;
-                Double_t E_z = 0;
-
-                Double_t E_y = fDriftEField; // [V/cm]
-
-                Double_t B_x = 0;
-                Double_t B_y = 0;
-                Double_t B_z = 0;
-                Double_t moduleB = 0;
-
-                Double_t vDrift_x = 0;
-                Double_t vDrift_y = 0;
-                Double_t vDrift_z = 0;
-
-                Double_t cteMult = 0;
-                Double_t cteMod = 0;
-                Double_t productEB = 0;
-
-                Double_t recoverDriftTimeStep = 0.;
-                Bool_t recoverStep = kTRUE;
-
-                Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
-
-                //Auxiliar values to obtain the velocities after the first callback to make the second and definitive callback
-                Double_t auxx;
-                Double_t auxy;
-                Double_t auxz;
-
-                sigmaLong = sqrt(time * 2 * fLongDiff);
-                sigmaTransv = sqrt(time * 2 * fTransDiff);
-                cloudLong = 0;
-                cloudTransv = 0;
-
-                LOG(debug) << "R3BGTPCCal2Hit::Exec, INITIAL VALUES: \tTimeToRun=" << accDriftTime << " [ns]"
-                           << " \tx=" << x << "  \ty=" << y << " \tz=" << z << " [cm]";
-
-                // Calculation Loop till accDriftTime = 0
-                while (accDriftTime > 0.)
-                {
-                    // We adjust the time for the last step before reaching time=0
-                    if (accDriftTime - fDriftTimeStep < 0.0)
-                    {
-                        if (recoverStep)
-                        {
-                            recoverDriftTimeStep = fDriftTimeStep;
-                        }
-                        recoverStep = kFALSE;
-                        fDriftTimeStep = accDriftTime;
-                    }
-
-                    B_x = 1e4 * gladField->GetBx(x, y, z); // Field components return in [kG], moved to [V ns cm^-2]
-                    B_y = 1e4 * gladField->GetBy(x, y, z);
-                    B_z = 1e4 * gladField->GetBz(x, y, z);
-
-                    moduleB = TMath::Sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // [V ns cm^-2]
-                    cteMod = 1 / (1 + mu * mu * moduleB * moduleB);           // dimensionless
-                    cteMult = mu * cteMod;                                    // [cm^2 V^-1 ns^-1]
-                    productEB = E_y * B_y; // E_x*B_x + E_y*B_y + E_z*B_z; [V^2 ns cm^-3]
-
-                    // Drift velocities for auxiliar point finding
-                    vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x);  //[cm/ns]
-                    vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y);               //[cm/ns]
-                    vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); //[cm/ns]
-
-                    // Point where we calculate the velocity vector for reversion
-                    auxx = x - vDrift_x * fDriftTimeStep;
-                    auxy = y + vDrift_y * fDriftTimeStep;
-                    auxz = z - vDrift_z * fDriftTimeStep;
-
-                    // Field in the auxiliar point
-                    B_x = 1e4 * gladField->GetBx(auxx, auxy, auxz);
-                    B_y = 1e4 * gladField->GetBy(auxx, auxy, auxz);
-                    B_z = 1e4 * gladField->GetBz(auxx, auxy, auxz);
-
-                    moduleB = TMath::Sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // [V ns cm^-2]
-                    cteMod = 1 / (1 + mu * mu * moduleB * moduleB);           // dimensionless
-                    cteMult = mu * cteMod;                                    // [cm^2 V^-1 ns^-1]
-                    productEB = E_y * B_y; // E_x*B_x + E_y*B_y + E_z*B_z; [V^2 ns cm^-3]
-
-                    // Drift velocities
-                    vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x);  //[cm/ns]
-                    vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y);               //[cm/ns]
-                    vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); //[cm/ns]
-
-                    //Use vector velocity (reversed) in the initial point to move backwards
-                    x = x - vDrift_x * fDriftTimeStep;
-                    y = y + vDrift_y * fDriftTimeStep;
-                    z = z - vDrift_z * fDriftTimeStep;
-
-                    // Taking account of clouds widths
-                    cloudLong += fDriftTimeStep * 2 * fLongDiff;
-                    cloudTransv += fDriftTimeStep * 2 * fTransDiff * cteMod;
-
-                    //Resting time update
-                    accDriftTime = accDriftTime - fDriftTimeStep;
-                    LOG(debug) << "R3BGTPCCal2Hit::Exec, NEW VALUES: accDriftTime=" << accDriftTime << " [ns]"
-                               << " x=" << x << " y=" << y << " z=" << z << " [cm]" << " Drift_v "<<vDrift_x<<" fDriftTimeStep "<<fDriftTimeStep;
-                }
-                // Once the last step adjust is done, reset the variables.
-                if (recoverDriftTimeStep)
-                {
-                    fDriftTimeStep = recoverDriftTimeStep;
-                    recoverDriftTimeStep = 0.;
-                    recoverStep = kTRUE;
-                }
-                //Comparing sigmas obtained in both ways
-                LOG(debug)<<"Comparing sigmas... Approx: "<<sigmaLong<<" "<<sigmaTransv<<";  Step by step: "<<TMath::Sqrt(cloudLong)<<" "<<TMath::Sqrt(cloudTransv);
-            }
             // Adding the hit relevant info for the mean
-            hitx += x * counts;
-            hity += y * counts;
-            hitz += z * counts;
-            hitlW += sigmaLong * counts;
+            hitx += point->x * counts;
+            hity += point->y * counts;
+            hitz += point->z * counts;
+            hitlW += point->sigmaLong * counts;
             pad_counts += counts;
         }
         //Final Hit values calculated by weighted mean
@@ -349,6 +224,61 @@ void R3BGTPCCal2Hit::Exec(Option_t* opt)
     return;
 }
 
+void R3BGTPCCal2Hit::ResetBackPoints(Int_t numBuckets)
+{
+    fNumBuckets = numBuckets;
+    fBackIndex.assign((size_t)fTPCMap->GetNumPads() * fNumBuckets, -1);
+    fBackPoints.clear();
+}
+
+const R3BGTPCCal2Hit::BackPoint* R3BGTPCCal2Hit::GetBackPoint(Int_t pad, Int_t bucket)
+{
+    if (pad < 0 || pad >= fTPCMap->GetNumPads())
+        return nullptr;
+    Int_t& index = fBackIndex[(size_t)pad * fNumBuckets + bucket];
+    if (index == kInvalidPad)
+        return nullptr;
+    if (index >= 0)
+        return &fBackPoints[index];
+
+    Double_t z, x; // [mm]
+    if (!fTPCMap->GetPadCenter(pad, z, x))
+    {
+        index = kInvalidPad;
+        return nullptr;
+    }
+    z = z / 10.0; //[cm] (pad centers in mm)
+    x = x / 10.0;
+    Double_t y = -fHalfSizeTPC_Y; //Start at pad plane
+    Double_t sigmaLong = 0;       //aprox for the whole time of reconstruction
+
+    x = x + fOffsetX; //[cm]
+    z = z + fOffsetZ; //[cm]
+    Double_t time = bucket * fTimeBinSize + 0.5 * fTimeBinSize; //[ns] moving from TimeBuckets to ns; adding the half of
+                                                                //the size of the bin to take the center of the bin
+
+    // Reconstruction without Langevin
+    if (fLangevinBack == kFALSE)
+    {
+        y = y + time * fDriftVelocity; // [cm] Simple projection case -> Same x,z just moving in coord y
+    }
+    // Reconstruction with Langevin
+    if (fLangevinBack == kTRUE)
+    {
+        sigmaLong = sqrt(time * 2 * fLongDiff);
+        Double_t sigmaTransv = sqrt(time * 2 * fTransDiff);
+        // step by step widths
+        Double_t cloudSigmaTransv, cloudSigmaLong;
+        fDriftKernel.DriftBackward(x, y, z, time, cloudSigmaTransv, cloudSigmaLong);
+        //Comparing sigmas obtained in both ways
+        LOG(debug)<<"Comparing sigmas... Approx: "<<sigmaLong<<" "<<sigmaTransv<<";  Step by step: "<<cloudSigmaLong<<" "<<cloudSigmaTransv;
+    }
+
+    index = fBackPoints.size();
+    fBackPoints.push_back({ x, y, z, sigmaLong });
+    return &fBackPoints[index];
+}
+
 void R3BGTPCCal2Hit::Finish() {}
 
 void R3BGTPCCal2Hit::Reset()
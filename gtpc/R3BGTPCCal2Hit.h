@@ -18,9 +18,11 @@
 #include "R3BGTPCCalData.h"
 #include "R3BGTPCHitData.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCDriftKernel.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCMapRegistry.h"
 
 class TClonesArray;
 
@@ -53,11 +55,11 @@ class R3BGTPCCal2Hit : public FairTask
 
     /** Accessor to select online mode **/
     void SetOnline(Bool_t option) { fOnline = option; }
-    void SetRecoFlag(Bool_t BooleanFlag){fLangevinBack = BooleanFlag;}
-
-    typedef boost::multi_array<double, 3> multiarray;
-    typedef multiarray::index index;
-    multiarray PadCoordArr;
+    void SetRecoFlag(Bool_t BooleanFlag)
+    {
+        fLangevinBack = BooleanFlag;
+        fBackIndex.clear();
+    }
 
   private:
     void SetParameter();
@@ -85,7 +87,9 @@ class R3BGTPCCal2Hit : public FairTask
 
     TClonesArray* fCalCA;
     TClonesArray* fHitCA;
-    std::shared_ptr<R3BGTPCMap> fTPCMap;
+    std::shared_ptr<const R3BGTPCMap> fTPCMap; //!< Map container, shared (R3BGTPCMapRegistry)
+    R3BGTPCFieldCache fFieldCache;   //!< GLAD field sampled over the drift volume
+    R3BGTPCDriftKernel fDriftKernel; //!< Backward Langevin integration
 
     Bool_t fOnline; // Selector for online data storage
 
@@ -93,6 +97,23 @@ class R3BGTPCCal2Hit : public FairTask
     //True: Reconstruction with Langevin equations
     //False: Reconstruction already done
 
+    // Point of the pad plane (pad center, time bucket) drifted back to its creation point. It only
+    // depends on the parameters, so it is computed once when first needed and kept for all events
+    struct BackPoint
+    {
+        Double_t x, y, z;   // [cm]
+        Double_t sigmaLong; // [cm]
+    };
+    static const Int_t kInvalidPad = -2;
+    Int_t fNumBuckets;                   //!< Time buckets per pad in fBackIndex
+    std::vector<Int_t> fBackIndex;       //!< Index in fBackPoints of [pad * fNumBuckets + bucket], -1 not computed
+    std::vector<BackPoint> fBackPoints;  //!< Back-drifted points computed so far
+
+    /** Clears the back-drifted points for calibrated data of numBuckets time buckets **/
+    void ResetBackPoints(Int_t numBuckets);
+    /** Back-drifted point of a time bucket of a pad, nullptr for an invalid pad **/
+    const BackPoint* GetBackPoint(Int_t pad, Int_t bucket);
+
     /** Private method AddHitData**/
     //** Adds a Hit to the HitCollection
     R3BGTPCHitData* AddHitData(Double_t x, Double_t y, Double_t z, Double_t longWidth, Double_t energy);
@@ -0,0 +1,143 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+#include "R3BGTPCDigitizer.h"
+#include "R3BGTPCCalData.h"
+#include "R3BGTPCProjPoint.h"
+
+#include "TClonesArray.h"
+
+#include <algorithm>
+
+R3BGTPCDigitizer::R3BGTPCDigitizer()
+    : fNumPads(0)
+    , fOutputMode(0)
+    , fTrackInfo()
+{
+}
+
+void R3BGTPCDigitizer::Init(Int_t nPads, Int_t outputMode)
+{
+    fNumPads = nPads;
+    fOutputMode = outputMode;
+    fPadElectrons.assign(fNumPads, 0);
+    fTouchedPads.clear();
+    fTouchedPads.reserve(fNumPads);
+    fPadADC.clear();
+    fPadTimes.clear();
+    fPadTrackInfo.clear();
+    if (fOutputMode == 0)
+    {
+        fPadADC.assign(fNumPads * kNumTimeBuckets, 0);
+    }
+    else if (fOutputMode == 1)
+    {
+        fPadTimes.assign(fNumPads, std::vector<Double_t>());
+        fPadTrackInfo.assign(fNumPads, TrackInfo());
+    }
+}
+
+void R3BGTPCDigitizer::SetTrackInfo(Int_t evtID,
+                                    Int_t PDGCode,
+                                    Int_t MotherId,
+                                    Double_t x0,
+                                    Double_t y0,
+                                    Double_t z0,
+                                    Double_t px0,
+                                    Double_t py0,
+                                    Double_t pz0)
+{
+    fTrackInfo.evtID = evtID;
+    fTrackInfo.PDGCode = PDGCode;
+    fTrackInfo.MotherId = MotherId;
+    fTrackInfo.x0 = x0;
+    fTrackInfo.y0 = y0;
+    fTrackInfo.z0 = z0;
+    fTrackInfo.px0 = px0;
+    fTrackInfo.py0 = py0;
+    fTrackInfo.pz0 = pz0;
+}
+
+void R3BGTPCDigitizer::Flush(TClonesArray* output)
+{
+    for (auto padID : fTouchedPads)
+    {
+        if (fOutputMode == 0)
+        { // Output: TClonesArray of R3BGTPCCalData
+            new ((*output)[output->GetEntriesFast()])
+                R3BGTPCCalData(padID, &fPadADC[padID * kNumTimeBuckets], kNumTimeBuckets); // zero-suppressed
+        }
+        else if (fOutputMode == 1)
+        { // Output: TClonesArray of R3BGTPCProjPoint
+            const std::vector<Double_t>& times = fPadTimes[padID];
+            const TrackInfo& info = fPadTrackInfo[padID];
+            R3BGTPCProjPoint* projPoint = new ((*output)[output->GetEntriesFast()]) R3BGTPCProjPoint(padID,
+                                                                                                    times[0],
+                                                                                                    1,
+                                                                                                    info.evtID,
+                                                                                                    info.PDGCode,
+                                                                                                    info.MotherId,
+                                                                                                    info.x0,
+                                                                                                    info.y0,
+                                                                                                    info.z0,
+                                                                                                    info.px0,
+                                                                                                    info.py0,
+                                                                                                    info.pz0);
+            for (size_t t = 1; t < times.size(); t++)
+            {
+                projPoint->AddCharge();
+                projPoint->SetTimeDistr(times[t], 1);
+            }
+        }
+    }
+    Reset();
+}
+
+void R3BGTPCDigitizer::Reset()
+{
+    for (auto padID : fTouchedPads)
+    {
+        if (fOutputMode == 0)
+            std::fill_n(&fPadADC[padID * kNumTimeBuckets], kNumTimeBuckets, 0);
+        else if (fOutputMode == 1)
+            fPadTimes[padID].clear();
+        fPadElectrons[padID] = 0;
+    }
+    fTouchedPads.clear();
+}
+
+void R3BGTPCDigitizer::Merge(R3BGTPCDigitizer& other)
+{
+    for (auto padID : other.fTouchedPads)
+    {
+        if (fPadElectrons[padID] == 0)
+        {
+            fTouchedPads.push_back(padID);
+            if (fOutputMode == 1)
+                fPadTrackInfo[padID] = other.fPadTrackInfo[padID];
+        }
+        fPadElectrons[padID] += other.fPadElectrons[padID];
+        if (fOutputMode == 0)
+        {
+            UShort_t* padADC = &fPadADC[padID * kNumTimeBuckets];
+            const UShort_t* otherADC = &other.fPadADC[padID * kNumTimeBuckets];
+            for (Int_t t = 0; t < kNumTimeBuckets; t++)
+                padADC[t] += otherADC[t];
+        }
+        else if (fOutputMode == 1)
+        {
+            const std::vector<Double_t>& times = other.fPadTimes[padID];
+            fPadTimes[padID].insert(fPadTimes[padID].end(), times.begin(), times.end());
+        }
+    }
+    other.Reset();
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCDigitizer.h
+ * Pad x time bucket accumulator shared by the digitization tasks
+ * (R3BGTPCProjector, R3BGTPCLangevin)
+ **/
+#ifndef R3BGTPCDIGITIZER_H
+#define R3BGTPCDIGITIZER_H
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TClonesArray;
+
+/**
+ * GTPC digitizer backend
+ *
+ * Collects the electrons reaching the pad plane during one event in a dense
+ * per-pad buffer, allocated once by Init, and writes the pads that were hit to
+ * the output TClonesArray in the order they were first hit:
+ *   outputMode 0: R3BGTPCCalData, time clamped into kNumTimeBuckets buckets, zero-suppressed
+ *   outputMode 1: R3BGTPCProjPoint, with the track information of the first electron
+ * Digitizers filled in parallel from consecutive parts of the event can be merged
+ * in order, giving the same output as a single digitizer filled with the whole event.
+ */
+class R3BGTPCDigitizer
+{
+  public:
+    struct TrackInfo
+    {
+        Int_t evtID, PDGCode, MotherId;
+        Double_t x0, y0, z0, px0, py0, pz0;
+    };
+
+    /** Default constructor **/
+    R3BGTPCDigitizer();
+
+    /** Allocates the accumulator for nPads pads and selects Cal(0) or ProjPoint(1) as output **/
+    void Init(Int_t nPads, Int_t outputMode);
+
+    /** Track information attached to the pads first hit by the following electrons **/
+    void SetTrackInfo(Int_t evtID,
+                      Int_t PDGCode,
+                      Int_t MotherId,
+                      Double_t x0,
+                      Double_t y0,
+                      Double_t z0,
+                      Double_t px0,
+                      Double_t py0,
+                      Double_t pz0);
+    void SetTrackInfo(const TrackInfo& info) { fTrackInfo = info; }
+
+    /** Adds one electron reaching pad padID (0 to nPads-1) at time [time bins] **/
+    inline void AddElectron(Int_t padID, Double_t time)
+    {
+        if (fPadElectrons[padID]++ == 0)
+        {
+            fTouchedPads.push_back(padID);
+            if (fOutputMode == 1)
+                fPadTrackInfo[padID] = fTrackInfo;
+        }
+        if (fOutputMode == 0)
+        {
+            if (time < 0)
+                time = 0; // Fills (first) underflow bin
+            else if (time > kNumTimeBuckets - 1)
+                time = kNumTimeBuckets - 1; // Fills (last) overflow bin
+            fPadADC[padID * kNumTimeBuckets + (Int_t)time]++;
+        }
+        else if (fOutputMode == 1)
+        {
+            fPadTimes[padID].push_back(time);
+        }
+    }
+
+    /** Writes the pads hit since the last call to output and resets the accumulator **/
+    void Flush(TClonesArray* output);
+
+    /** Drops the electrons collected since the last call to Flush **/
+    void Reset();
+
+    /** Adds the electrons of other, collected after the ones of this digitizer, and resets other **/
+    void Merge(R3BGTPCDigitizer& other);
+
+    Int_t GetNumPads() const { return fNumPads; }
+    Int_t GetNumTouchedPads() const { return fTouchedPads.size(); }
+
+    static const Int_t kNumTimeBuckets = 512; //!< Time buckets of R3BGTPCCalData
+
+  private:
+    Int_t fNumPads;                               //!< Number of pads in the pad plane
+    Int_t fOutputMode;                            //!< Cal(0) or ProjPoint(1)
+    std::vector<Int_t> fPadElectrons;             //!< Electrons collected per pad
+    std::vector<UShort_t> fPadADC;                //!< Time bucket content per pad [pad * kNumTimeBuckets + bucket]
+    std::vector<std::vector<Double_t>> fPadTimes; //!< Arrival times per pad [time bins]
+    std::vector<TrackInfo> fPadTrackInfo;         //!< Track of the first electron reaching each pad
+    std::vector<Int_t> fTouchedPads;              //!< Pads hit, in order of first hit
+    TrackInfo fTrackInfo;                         //!< Current track information
+};
+
+#endif // R3BGTPCDIGITIZER_H
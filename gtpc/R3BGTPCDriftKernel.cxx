@@ -0,0 +1,293 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+#include "R3BGTPCDriftKernel.h"
+
+#include "TMath.h"
+#include "TRandom.h"
+
+namespace
+{
+    // Uniform numbers of a batch step from one stream per electron (only the moving ones)
+    struct StreamUniforms
+    {
+        R3BGTPCRandomStream* random;
+        void Fill(Int_t n, const Int_t* moving, Double_t (*u)[R3BGTPCDriftKernel::kBatchSize])
+        {
+            for (Int_t i = 0; i < n; i++)
+            {
+                if (!moving[i])
+                    continue;
+                for (Int_t k = 0; k < 4; k++)
+                    u[k][i] = random[i].Rndm();
+            }
+        }
+    };
+
+    // Uniform numbers of a batch step from a single generator
+    struct GeneratorUniforms
+    {
+        TRandom* random;
+        void Fill(Int_t n, const Int_t*, Double_t (*u)[R3BGTPCDriftKernel::kBatchSize])
+        {
+            for (Int_t k = 0; k < 4; k++)
+                random->RndmArray(n, u[k]);
+        }
+    };
+} // namespace
+
+R3BGTPCDriftKernel::R3BGTPCDriftKernel()
+    : fField(nullptr)
+    , fDriftVelocity(0.)
+    , fDriftEField(0.)
+    , fTransDiff(0.)
+    , fLongDiff(0.)
+    , fDriftTimeStep(0.)
+    , fPadPlaneY(0.)
+    , fStepTolerance(0.)
+{
+}
+
+void R3BGTPCDriftKernel::Init(const R3BGTPCFieldCache* field,
+                              Double_t driftVelocity,
+                              Double_t driftEField,
+                              Double_t transDiff,
+                              Double_t longDiff,
+                              Double_t driftTimeStep,
+                              Double_t padPlaneY)
+{
+    fField = field;
+    fDriftVelocity = driftVelocity;
+    fDriftEField = driftEField;
+    fTransDiff = transDiff;
+    fLongDiff = longDiff;
+    fDriftTimeStep = driftTimeStep;
+    fPadPlaneY = padPlaneY;
+}
+
+void R3BGTPCDriftKernel::DriftCentroid(Double_t& ele_x,
+                                       Double_t& ele_y,
+                                       Double_t& ele_z,
+                                       Double_t& accDriftTime,
+                                       Double_t& sigmaTransv,
+                                       Double_t& sigmaTime) const
+{
+    Double_t E_y = fDriftEField;        // [V/cm]
+    Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
+    Double_t sigma2Transv = 0.;         // [cm^2]
+    Double_t sigma2Long = 0.;           // [cm^2]
+    Double_t vDrift_y = fDriftVelocity;
+    Double_t driftTimeStep = fDriftTimeStep;
+
+    // same equations as Drift, following the mean position
+    while (ele_y > fPadPlaneY)
+    {
+        driftTimeStep = NextStep(ele_x, ele_y, ele_z, driftTimeStep);
+        Double_t B_x, B_y, B_z;
+        fField->GetField(ele_x, ele_y, ele_z, B_x, B_y, B_z);
+        B_x = 1e4 * B_x; // Field components return in [kG], moved to [V ns cm^-2]
+        B_y = 1e4 * B_y;
+        B_z = 1e4 * B_z;
+
+        Double_t moduleB = std::sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // [V ns cm^-2]
+        Double_t cteMod = 1 / (1 + mu * mu * moduleB * moduleB);         // adimensional
+        Double_t cteMult = mu * cteMod;                                  // [cm^2 V^-1 ns^-1]
+        Double_t productEB = E_y * B_y;                                  // [V^2 ns cm^-3]
+
+        Double_t vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x);  // [cm/ns]
+        vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y);                       // [cm/ns]
+        Double_t vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); // [cm/ns]
+
+        // adjusting the last step before the pad plane
+        if (ele_y - vDrift_y * driftTimeStep < fPadPlaneY)
+            driftTimeStep = (ele_y - fPadPlaneY) / vDrift_y;
+
+        sigma2Transv += driftTimeStep * 2 * fTransDiff * cteMod;
+        sigma2Long += driftTimeStep * 2 * fLongDiff;
+        ele_x += vDrift_x * driftTimeStep;
+        ele_y -= vDrift_y * driftTimeStep;
+        ele_z += vDrift_z * driftTimeStep;
+        accDriftTime += driftTimeStep;
+    }
+
+    sigmaTransv = std::sqrt(sigma2Transv);
+    // the longitudinal width at the pad plane is seen as a spread of the arrival time
+    sigmaTime = std::sqrt(sigma2Long) / vDrift_y;
+}
+
+void R3BGTPCDriftKernel::DriftBackward(Double_t& x,
+                                       Double_t& y,
+                                       Double_t& z,
+                                       Double_t accDriftTime,
+                                       Double_t& sigmaTransv,
+                                       Double_t& sigmaLong) const
+{
+    Double_t E_y = fDriftEField;        // [V/cm]
+    Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
+    Double_t B_x, B_y, B_z;
+    Double_t cloudLong = 0.; // [cm^2]
+    Double_t cloudTransv = 0.;
+    Double_t driftTimeStep = fDriftTimeStep;
+
+    LOG(debug) << "R3BGTPCDriftKernel::DriftBackward, INITIAL VALUES: \tTimeToRun=" << accDriftTime << " [ns]"
+               << " \tx=" << x << "  \ty=" << y << " \tz=" << z << " [cm]";
+
+    // Calculation Loop till accDriftTime = 0
+    while (accDriftTime > 0.)
+    {
+        driftTimeStep = NextStep(x, y, z, driftTimeStep);
+        // the last step ends at time=0
+        Double_t step = std::min(driftTimeStep, accDriftTime);
+
+        fField->GetField(x, y, z, B_x, B_y, B_z);
+        B_x = 1e4 * B_x; // Field components return in [kG], moved to [V ns cm^-2]
+        B_y = 1e4 * B_y;
+        B_z = 1e4 * B_z;
+
+        Double_t moduleB = std::sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // [V ns cm^-2]
+        Double_t cteMod = 1 / (1 + mu * mu * moduleB * moduleB);         // dimensionless
+        Double_t cteMult = mu * cteMod;                                  // [cm^2 V^-1 ns^-1]
+        Double_t productEB = E_y * B_y;                                  // [V^2 ns cm^-3]
+
+        // Drift velocities for auxiliar point finding
+        Double_t vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x);  //[cm/ns]
+        Double_t vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y);               //[cm/ns]
+        Double_t vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); //[cm/ns]
+
+        // Field in the point where we calculate the velocity vector for reversion
+        fField->GetField(x - vDrift_x * step, y + vDrift_y * step, z - vDrift_z * step, B_x, B_y, B_z);
+        B_x = 1e4 * B_x;
+        B_y = 1e4 * B_y;
+        B_z = 1e4 * B_z;
+
+        moduleB = std::sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // [V ns cm^-2]
+        cteMod = 1 / (1 + mu * mu * moduleB * moduleB);         // dimensionless
+        cteMult = mu * cteMod;                                  // [cm^2 V^-1 ns^-1]
+        productEB = E_y * B_y;                                  // [V^2 ns cm^-3]
+
+        vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB * B_x);  //[cm/ns]
+        vDrift_y = cteMult * (E_y + mu * mu * productEB * B_y);               //[cm/ns]
+        vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB * B_z); //[cm/ns]
+
+        // Use vector velocity (reversed) in the initial point to move backwards
+        x = x - vDrift_x * step;
+        y = y + vDrift_y * step;
+        z = z - vDrift_z * step;
+
+        // Taking account of clouds widths
+        cloudLong += step * 2 * fLongDiff;
+        cloudTransv += step * 2 * fTransDiff * cteMod;
+
+        // Resting time update
+        accDriftTime = accDriftTime - step;
+        LOG(debug) << "R3BGTPCDriftKernel::DriftBackward, NEW VALUES: accDriftTime=" << accDriftTime << " [ns]"
+                   << " x=" << x << " y=" << y << " z=" << z << " [cm]"
+                   << " Drift_v " << vDrift_x << " driftTimeStep " << step;
+    }
+
+    sigmaTransv = std::sqrt(cloudTransv);
+    sigmaLong = std::sqrt(cloudLong);
+}
+
+void R3BGTPCDriftKernel::DriftBatch(Int_t n,
+                                    Double_t* x,
+                                    Double_t* y,
+                                    Double_t* z,
+                                    Double_t* time,
+                                    R3BGTPCRandomStream* random) const
+{
+    StreamUniforms source = { random };
+    DriftBatchImpl(n, x, y, z, time, source);
+}
+
+void R3BGTPCDriftKernel::DriftBatch(Int_t n, Double_t* x, Double_t* y, Double_t* z, Double_t* time, TRandom* random)
+    const
+{
+    GeneratorUniforms source = { random };
+    DriftBatchImpl(n, x, y, z, time, source);
+}
+
+template <typename UniformSource>
+void R3BGTPCDriftKernel::DriftBatchImpl(Int_t n,
+                                        Double_t* x,
+                                        Double_t* y,
+                                        Double_t* z,
+                                        Double_t* time,
+                                        UniformSource& source) const
+{
+    Double_t B_x[kBatchSize], B_y[kBatchSize], B_z[kBatchSize];
+    Double_t driftTimeStep[kBatchSize]; // per electron, shortened for the last step before the pad plane
+    Double_t u[4][kBatchSize];          // uniform numbers of the step
+    Int_t moving[kBatchSize];           // electrons not yet at the pad plane
+
+    Double_t E_y = fDriftEField;        // [V/cm]
+    Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
+
+    Int_t nMoving = 0;
+    for (Int_t i = 0; i < n; i++)
+    {
+        driftTimeStep[i] = fDriftTimeStep;
+        moving[i] = y[i] > fPadPlaneY;
+        nMoving += moving[i];
+        for (Int_t k = 0; k < 4; k++)
+            u[k][i] = 0.5; // keeps the numbers of the electrons at the pad plane finite
+    }
+
+    while (nMoving > 0)
+    {
+        // field lookup, one cell per electron
+        for (Int_t i = 0; i < n; i++)
+        {
+            driftTimeStep[i] = NextStep(x[i], y[i], z[i], driftTimeStep[i]);
+            fField->GetField(x[i], y[i], z[i], B_x[i], B_y[i], B_z[i]);
+        }
+        source.Fill(n, moving, u);
+
+        nMoving = 0;
+        for (Int_t i = 0; i < n; i++)
+        {
+            Double_t bx = 1e4 * B_x[i]; // Field components return in [kG], moved to [V ns cm^-2]
+            Double_t by = 1e4 * B_y[i];
+            Double_t bz = 1e4 * B_z[i];
+            Double_t module2B = bx * bx + by * by + bz * bz;   // [V^2 ns^2 cm^-4]
+            Double_t cteMod = 1 / (1 + mu * mu * module2B);    // adimensional
+            Double_t cteMult = mu * cteMod;                    // [cm^2 V^-1 ns^-1]
+            Double_t productEB = E_y * by;                     // [V^2 ns cm^-3]
+            Double_t vDrift_x = cteMult * (mu * (E_y * bz) + mu * mu * productEB * bx);  // [cm/ns]
+            Double_t vDrift_y = cteMult * (E_y + mu * mu * productEB * by);              // [cm/ns]
+            Double_t vDrift_z = cteMult * (mu * (-E_y * bx) + mu * mu * productEB * bz); // [cm/ns]
+
+            // adjusting the last step before the pad plane
+            Double_t step = (y[i] - vDrift_y * driftTimeStep[i] < fPadPlaneY) ? (y[i] - fPadPlaneY) / vDrift_y
+                                                                              : driftTimeStep[i];
+
+            // Box-Muller, two pairs of uniform numbers give the three Gaussian numbers of the step
+            Double_t r1 = std::sqrt(-2. * std::log(u[0][i]));
+            Double_t r2 = std::sqrt(-2. * std::log(u[2][i]));
+            Double_t gaus_x = r1 * std::cos(TMath::TwoPi() * u[1][i]);
+            Double_t gaus_y = r1 * std::sin(TMath::TwoPi() * u[1][i]);
+            Double_t gaus_z = r2 * std::cos(TMath::TwoPi() * u[3][i]);
+
+            Double_t sigmaTransvStep = std::sqrt(step * 2 * fTransDiff * cteMod);
+            Double_t sigmaLongStep = std::sqrt(step * 2 * fLongDiff);
+
+            Bool_t move = moving[i];
+            x[i] = move ? x[i] + vDrift_x * step + sigmaTransvStep * gaus_x : x[i]; // [cm]
+            y[i] = move ? y[i] - vDrift_y * step + sigmaLongStep * gaus_y : y[i];   // [cm]
+            z[i] = move ? z[i] + vDrift_z * step + sigmaTransvStep * gaus_z : z[i]; // [cm]
+            time[i] = move ? time[i] + step : time[i];                              // [ns]
+            driftTimeStep[i] = move ? step : driftTimeStep[i];
+            moving[i] = y[i] > fPadPlaneY;
+            nMoving += moving[i];
+        }
+    }
+}
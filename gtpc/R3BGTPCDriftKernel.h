@@ -0,0 +1,191 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCDriftKernel.h
+ * Langevin drift of the electrons from their creation point to the pad plane
+ **/
+#ifndef R3BGTPCDRIFTKERNEL_H
+#define R3BGTPCDRIFTKERNEL_H
+
+#include "FairLogger.h"
+#include "R3BGTPCFieldCache.h"
+#include "R3BGTPCRandomStream.h"
+
+#include "Rtypes.h"
+
+#include <algorithm>
+#include <cmath>
+
+class TRandom;
+
+/**
+ * GTPC Langevin drift kernel
+ *
+ * Integrates the Langevin equation (vertical electric field, field from a
+ * R3BGTPCFieldCache) in steps of driftTimeStep, the last step being shortened
+ * to stop at the pad plane, with the diffusion added as Gaussian steps.
+ *   Drift:      one electron, any generator with Gaus(mean, sigma)
+ *   DriftBatch: up to kBatchSize electrons together, positions and times as
+ *               separate arrays. The electrons at the pad plane are masked off
+ *               and the Gaussian numbers come from a Box-Muller transform over
+ *               the whole batch, so the inner loops can be vectorized.
+ * Both give the same physics; the random sequences are different.
+ *   DriftCentroid: mean path without diffusion, returning the accumulated
+ *               diffusion widths at the pad plane (electron clouds, drift table).
+ *   DriftBackward: mean path from the pad plane back to the creation point.
+ * With a step tolerance, each electron keeps its own time step: it grows (at
+ * most doubling, and never beyond one field cache spacing of drift) while the
+ * field change along a step stays below the tolerance and shrinks where the
+ * field varies, down to kMinStepFraction of driftTimeStep.
+ */
+class R3BGTPCDriftKernel
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCDriftKernel();
+
+    /** Drift parameters [cm, ns, V/cm], the pad plane being at y = padPlaneY [cm] **/
+    void Init(const R3BGTPCFieldCache* field,
+              Double_t driftVelocity,
+              Double_t driftEField,
+              Double_t transDiff,
+              Double_t longDiff,
+              Double_t driftTimeStep,
+              Double_t padPlaneY);
+
+    /** Adaptive time step: maximum field change [kG] along one step; 0 (default) keeps the fixed step **/
+    void SetStepTolerance(Double_t tolerance) { fStepTolerance = tolerance; }
+
+    /** Drifts one electron from (x,y,z) [cm] to the pad plane, adding the drift time to time [ns] **/
+    template <typename RNG>
+    void Drift(Double_t& x, Double_t& y, Double_t& z, Double_t& time, RNG& random) const;
+
+    /** Drifts the centroid of an electron cloud from (x,y,z) [cm] to the pad plane without diffusion,
+     * adding the drift time to time [ns]; sigmaTransv [cm] and sigmaTime [ns] are the widths that the
+     * diffusion accumulates along the path (longitudinal width seen as arrival time spread) **/
+    void DriftCentroid(Double_t& x, Double_t& y, Double_t& z, Double_t& time, Double_t& sigmaTransv, Double_t& sigmaTime)
+        const;
+
+    /** Drifts a point from the pad plane at (x,y,z) [cm] back to where it was time [ns] before, returning the
+     * widths sigmaTransv [cm] and sigmaLong [cm] that the diffusion accumulates along the path **/
+    void DriftBackward(Double_t& x, Double_t& y, Double_t& z, Double_t time, Double_t& sigmaTransv, Double_t& sigmaLong)
+        const;
+
+    static const Int_t kBatchSize = 16; //!< Maximum number of electrons of a batch
+
+    /** Drifts n (<= kBatchSize) electrons, random numbers from one stream per electron **/
+    void DriftBatch(Int_t n, Double_t* x, Double_t* y, Double_t* z, Double_t* time, R3BGTPCRandomStream* random) const;
+
+    /** Drifts n (<= kBatchSize) electrons, random numbers from a single generator **/
+    void DriftBatch(Int_t n, Double_t* x, Double_t* y, Double_t* z, Double_t* time, TRandom* random) const;
+
+    static constexpr Double_t kMinStepFraction = 0.01; //!< Smallest adaptive step, fraction of driftTimeStep
+
+  private:
+    /** Time step [ns] at (x,y,z) [cm] for an electron whose previous step was previousStep [ns] **/
+    inline Double_t NextStep(Double_t x, Double_t y, Double_t z, Double_t previousStep) const
+    {
+        if (fStepTolerance <= 0.)
+            return previousStep;
+        // the field seen by the electron changes at most by gradient * drift velocity * step,
+        // the gradient of the current cell being valid only up to one cell away
+        Double_t step = std::min(2. * previousStep, fField->GetSpacing() / fDriftVelocity);
+        Double_t change = fField->GetGradient(x, y, z) * fDriftVelocity * step; // [kG]
+        if (change > fStepTolerance)
+            step *= fStepTolerance / change;
+        return std::max(step, kMinStepFraction * fDriftTimeStep);
+    }
+
+    template <typename UniformSource>
+    void DriftBatchImpl(Int_t n, Double_t* x, Double_t* y, Double_t* z, Double_t* time, UniformSource& source) const;
+
+    const R3BGTPCFieldCache* fField; //!< Magnetic field [kG]
+    Double_t fDriftVelocity;         //!< Drift velocity in gas [cm/ns]
+    Double_t fDriftEField;           //!< Drift electric field [V/cm]
+    Double_t fTransDiff;             //!< Transversal diffusion coefficient [cm^2/ns]
+    Double_t fLongDiff;              //!< Longitudinal diffusion coefficient [cm^2/ns]
+    Double_t fDriftTimeStep;         //!< Time step of the integration [ns]
+    Double_t fPadPlaneY;             //!< Y of the pad plane [cm]
+    Double_t fStepTolerance;         //!< Maximum field change along a step [kG], 0 for the fixed step
+};
+
+template <typename RNG>
+void R3BGTPCDriftKernel::Drift(Double_t& ele_x, Double_t& ele_y, Double_t& ele_z, Double_t& accDriftTime, RNG& random) const
+{
+    Double_t E_y = fDriftEField; // in V/m
+    Double_t B_x = 0;
+    Double_t B_y = 0;
+    Double_t B_z = 0;
+    Double_t moduleB = 0;
+    Double_t vDrift_x = 0;
+    Double_t vDrift_y = 0;
+    Double_t vDrift_z = 0;
+    Double_t cteMult = 0;
+    Double_t cteMod = 0;
+    Double_t productEB = 0;
+
+    Double_t sigmaLongStep;
+    Double_t sigmaTransvStep;
+    Double_t driftTimeStep = fDriftTimeStep; // per electron, shortened for the last step before the pad plane
+
+    Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
+
+    LOG(debug) << "R3BGTPCDriftKernel::Drift, INITIAL VALUES: timeBeforeDrift=" << accDriftTime << " [ns]"
+               << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
+    while (ele_y > fPadPlaneY)
+    { // while not reaching the pad plane [cm]
+        driftTimeStep = NextStep(ele_x, ele_y, ele_z, driftTimeStep);
+        fField->GetField(ele_x, ele_y, ele_z, B_x, B_y, B_z);
+        B_x = 1e4 * B_x; // Field components return in [kG], moved to [V ns cm^-2]
+        B_y = 1e4 * B_y;
+        B_z = 1e4 * B_z;
+
+        moduleB = std::sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // in [V ns cm^-2]
+        cteMod = 1 / (1 + mu * mu * moduleB * moduleB);         // adimensional
+        cteMult = mu * cteMod;                                  // [cm^2 V^-1 ns^-1]
+
+        // assuming only vertical electric field in the next four lines
+        productEB = E_y * B_y; // E_x*B_x + E_y*B_y + E_z*B_z; [V^2 ns cm^-3]
+
+        vDrift_x = cteMult * (mu * (E_y * B_z) + mu * mu * productEB *
+                                                     B_x); // cte * (Ex + mu*(E_y*B_z-E_z*B_y) + mu*mu*productEB*B_x); [cm/ns]
+        vDrift_y = cteMult *
+                   (E_y + mu * mu * productEB * B_y); // cte * (Ey + mu*(E_z*B_x-E_x*B_z) + mu*mu*productEB*B_y); [cm/ns]
+        vDrift_z = cteMult * (mu * (-E_y * B_x) + mu * mu * productEB *
+                                                      B_z); // cte * (Ez + mu*(E_x*B_y-E_y*B_x) + mu*mu*productEB*B_z); [cm/ns]
+
+        LOG(debug) << "R3BGTPCDriftKernel::Drift, DRIFT VELOCITIES: vDrift_x=" << vDrift_x << " vDrift_y=" << vDrift_y
+                   << " vDrift_z=" << vDrift_z << " [cm/ns]";
+        // adjusting the last step before the pad plane
+        if (ele_y - vDrift_y * driftTimeStep < fPadPlaneY)
+            driftTimeStep = (ele_y - fPadPlaneY) / vDrift_y;
+
+        // reducing sigmaTransv (see http://web.ift.uib.no/~lipniack/detectors/lecture5/detector5.pdf)
+        // as B~B_y and E=E_y, let's simplify and apply the reduction to the transversal coefficient without
+        // projections
+        sigmaTransvStep = std::sqrt(driftTimeStep * 2 * fTransDiff * cteMod); // reduced by the factor cteMod=cteMult/mu
+        sigmaLongStep = std::sqrt(driftTimeStep * 2 * fLongDiff); // the same scaled to the length of the step
+        ele_x = random.Gaus(ele_x + vDrift_x * driftTimeStep, sigmaTransvStep); // [cm]
+        ele_y = random.Gaus(ele_y - vDrift_y * driftTimeStep, sigmaLongStep);   // [cm]
+        ele_z = random.Gaus(ele_z + vDrift_z * driftTimeStep, sigmaTransvStep); // [cm]
+        accDriftTime = accDriftTime + driftTimeStep;                            //[ns]
+
+        // TODO!!! CHECK THE NEGATIVE sign in the y directions three lines above...
+        // Could it be symmetric with the others (+) in case the electric field is negative in Y?
+        // Does it change other cross terms? Which one is correct?
+
+        LOG(debug) << "R3BGTPCDriftKernel::Drift, NEW VALUES: accDriftTime=" << accDriftTime << " [ns]"
+                   << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
+    }
+}
+
+#endif // R3BGTPCDRIFTKERNEL_H
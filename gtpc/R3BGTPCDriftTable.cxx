@@ -0,0 +1,216 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+#include "R3BGTPCDriftTable.h"
+#include "R3BGTPCDriftKernel.h"
+#include "R3BGTPCFieldCache.h"
+
+#include "FairLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const char kFileTag[8] = "GTPCDT3"; // file format tag and version
+    const Int_t kNumParameters = sizeof(R3BGTPCDriftTable::Parameters) / sizeof(Double_t);
+} // namespace
+
+R3BGTPCDriftTable::R3BGTPCDriftTable()
+    : fPar()
+    , fNx(0)
+    , fNy(0)
+    , fNz(0)
+    , fStepX(0.)
+    , fStepY(0.)
+    , fStepZ(0.)
+{
+}
+
+void R3BGTPCDriftTable::SetGrid(const Parameters& par)
+{
+    fPar = par;
+    fNx = std::max(2, (Int_t)std::ceil((par.xMax - par.xMin) / par.step) + 1);
+    fNy = std::max(2, (Int_t)std::ceil((par.yMax - par.yMin) / par.step) + 1);
+    fNz = std::max(2, (Int_t)std::ceil((par.zMax - par.zMin) / par.step) + 1);
+    fStepX = (par.xMax - par.xMin) / (fNx - 1);
+    fStepY = (par.yMax - par.yMin) / (fNy - 1);
+    fStepZ = (par.zMax - par.zMin) / (fNz - 1);
+    Int_t nNodes = fNx * fNy * fNz;
+    fDx.assign(nNodes, 0.);
+    fDz.assign(nNodes, 0.);
+    fTime.assign(nNodes, 0.);
+    fSigmaTransv.assign(nNodes, 0.);
+    fSigmaTime.assign(nNodes, 0.);
+}
+
+void R3BGTPCDriftTable::Build(const R3BGTPCFieldCache& field, const Parameters& par)
+{
+    SetGrid(par);
+    fPar.fieldChecksum = field.GetChecksum();
+
+    R3BGTPCDriftKernel kernel;
+    kernel.Init(&field, par.driftVelocity, par.driftEField, par.transDiff, par.longDiff, par.driftTimeStep, par.yMin);
+    kernel.SetStepTolerance(par.stepTolerance);
+
+    Int_t node = 0;
+    for (Int_t iz = 0; iz < fNz; iz++)
+        for (Int_t iy = 0; iy < fNy; iy++)
+            for (Int_t ix = 0; ix < fNx; ix++)
+            {
+                Double_t x = par.xMin + ix * fStepX;
+                Double_t y = par.yMin + iy * fStepY;
+                Double_t z = par.zMin + iz * fStepZ;
+                Double_t time = 0.;
+                Double_t sigmaTransv, sigmaTime;
+                kernel.DriftCentroid(x, y, z, time, sigmaTransv, sigmaTime);
+
+                fDx[node] = x - (par.xMin + ix * fStepX);
+                fDz[node] = z - (par.zMin + iz * fStepZ);
+                fTime[node] = time;
+                fSigmaTransv[node] = sigmaTransv;
+                fSigmaTime[node] = sigmaTime;
+                node++;
+            }
+
+    LOG(info) << "R3BGTPCDriftTable::Build: drift integrated from " << fNx << "x" << fNy << "x" << fNz
+              << " nodes";
+}
+
+Bool_t R3BGTPCDriftTable::Write(const char* fileName) const
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        LOG(error) << "R3BGTPCDriftTable::Write: Cannot open " << fileName;
+        return kFALSE;
+    }
+    Int_t nNodes = fNx * fNy * fNz;
+    file.write(kFileTag, sizeof(kFileTag));
+    file.write((const char*)&fPar, sizeof(Parameters));
+    file.write((const char*)&fNx, sizeof(Int_t));
+    file.write((const char*)&fNy, sizeof(Int_t));
+    file.write((const char*)&fNz, sizeof(Int_t));
+    for (auto array : { &fDx, &fDz, &fTime, &fSigmaTransv, &fSigmaTime })
+        file.write((const char*)array->data(), nNodes * sizeof(Float_t));
+    if (!file)
+    {
+        LOG(error) << "R3BGTPCDriftTable::Write: Error writing " << fileName;
+        return kFALSE;
+    }
+    LOG(info) << "R3BGTPCDriftTable::Write: Table written to " << fileName;
+    return kTRUE;
+}
+
+Bool_t R3BGTPCDriftTable::Read(const char* fileName, const Parameters& par, const R3BGTPCFieldCache& field)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        LOG(info) << "R3BGTPCDriftTable::Read: No table in " << fileName;
+        return kFALSE;
+    }
+    char tag[sizeof(kFileTag)];
+    Parameters filePar;
+    file.read(tag, sizeof(tag));
+    file.read((char*)&filePar, sizeof(Parameters));
+    if (!file || std::memcmp(tag, kFileTag, sizeof(kFileTag)) != 0)
+    {
+        LOG(warn) << "R3BGTPCDriftTable::Read: " << fileName << " is not a drift table";
+        return kFALSE;
+    }
+    if (filePar.fieldChecksum != field.GetChecksum())
+    {
+        LOG(info) << "R3BGTPCDriftTable::Read: " << fileName << " was built for another magnetic field";
+        return kFALSE;
+    }
+    Parameters expected = par;
+    expected.fieldChecksum = filePar.fieldChecksum;
+    const Double_t* fileValues = (const Double_t*)&filePar;
+    const Double_t* values = (const Double_t*)&expected;
+    for (Int_t i = 0; i < kNumParameters; i++)
+    {
+        if (std::fabs(fileValues[i] - values[i]) > 1e-9 * std::max(std::fabs(values[i]), 1.))
+        {
+            LOG(info) << "R3BGTPCDriftTable::Read: " << fileName << " was built with other parameters";
+            return kFALSE;
+        }
+    }
+
+    SetGrid(filePar);
+    Int_t nx, ny, nz;
+    file.read((char*)&nx, sizeof(Int_t));
+    file.read((char*)&ny, sizeof(Int_t));
+    file.read((char*)&nz, sizeof(Int_t));
+    if (!file || nx != fNx || ny != fNy || nz != fNz)
+    {
+        LOG(warn) << "R3BGTPCDriftTable::Read: Wrong grid in " << fileName;
+        fDx.clear();
+        return kFALSE;
+    }
+    Int_t nNodes = fNx * fNy * fNz;
+    for (auto array : { &fDx, &fDz, &fTime, &fSigmaTransv, &fSigmaTime })
+        file.read((char*)array->data(), nNodes * sizeof(Float_t));
+    if (!file)
+    {
+        LOG(warn) << "R3BGTPCDriftTable::Read: " << fileName << " is truncated";
+        fDx.clear();
+        return kFALSE;
+    }
+    LOG(info) << "R3BGTPCDriftTable::Read: Table read from " << fileName;
+    return kTRUE;
+}
+
+void R3BGTPCDriftTable::Lookup(Double_t x,
+                               Double_t y,
+                               Double_t z,
+                               Double_t& dx,
+                               Double_t& dz,
+                               Double_t& time,
+                               Double_t& sigmaTransv,
+                               Double_t& sigmaTime) const
+{
+    Double_t u = std::min(std::max((x - fPar.xMin) / fStepX, 0.), (Double_t)(fNx - 1));
+    Double_t v = std::min(std::max((y - fPar.yMin) / fStepY, 0.), (Double_t)(fNy - 1));
+    Double_t w = std::min(std::max((z - fPar.zMin) / fStepZ, 0.), (Double_t)(fNz - 1));
+    Int_t ix = std::min((Int_t)u, fNx - 2);
+    Int_t iy = std::min((Int_t)v, fNy - 2);
+    Int_t iz = std::min((Int_t)w, fNz - 2);
+    Double_t tx = u - ix;
+    Double_t ty = v - iy;
+    Double_t tz = w - iz;
+
+    Int_t i000 = (iz * fNy + iy) * fNx + ix;
+    Int_t corner[8] = { i000,
+                        i000 + 1,
+                        i000 + fNx,
+                        i000 + fNx + 1,
+                        i000 + fNx * fNy,
+                        i000 + fNx * fNy + 1,
+                        i000 + fNx * fNy + fNx,
+                        i000 + fNx * fNy + fNx + 1 };
+    Double_t weight[8] = { (1 - tx) * (1 - ty) * (1 - tz), tx * (1 - ty) * (1 - tz), (1 - tx) * ty * (1 - tz),
+                           tx * ty * (1 - tz),             (1 - tx) * (1 - ty) * tz, tx * (1 - ty) * tz,
+                           (1 - tx) * ty * tz,             tx * ty * tz };
+
+    dx = dz = time = sigmaTransv = sigmaTime = 0.;
+    for (Int_t c = 0; c < 8; c++)
+    {
+        dx += weight[c] * fDx[corner[c]];
+        dz += weight[c] * fDz[corner[c]];
+        time += weight[c] * fTime[corner[c]];
+        sigmaTransv += weight[c] * fSigmaTransv[corner[c]];
+        sigmaTime += weight[c] * fSigmaTime[corner[c]];
+    }
+}
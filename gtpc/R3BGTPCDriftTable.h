@@ -0,0 +1,95 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCDriftTable.h
+ * Precomputed electron transport from any point of the drift volume to the pad plane
+ **/
+#ifndef R3BGTPCDRIFTTABLE_H
+#define R3BGTPCDRIFTTABLE_H
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class R3BGTPCFieldCache;
+
+/**
+ * GTPC drift table
+ *
+ * For a fixed field, gas and drift parameters, the mean arrival point and time of
+ * an electron at the pad plane and the diffusion widths depend only on its start
+ * point. Build follows the mean path (R3BGTPCDriftKernel::DriftCentroid) from the
+ * nodes of a regular grid (pad plane at y = yMin) and keeps
+ * per node the mean displacement in x and z, the drift time and the accumulated
+ * transversal (position) and longitudinal (time) widths. Lookup interpolates them
+ * trilinearly. The table is saved in a binary file together with the parameters
+ * it was built with, including a checksum of the sampled field, and only loaded
+ * back for the same parameters and field.
+ */
+class R3BGTPCDriftTable
+{
+  public:
+    /** Parameters defining the table, also stored in the file header **/
+    struct Parameters
+    {
+        Double_t driftVelocity; // [cm/ns]
+        Double_t driftEField;   // [V/cm]
+        Double_t transDiff;     // [cm^2/ns]
+        Double_t longDiff;      // [cm^2/ns]
+        Double_t driftTimeStep; // [ns]
+        Double_t stepTolerance; // [kG], 0 for a fixed step
+        Double_t xMin, xMax;    // [cm]
+        Double_t yMin, yMax;    // [cm], pad plane at yMin
+        Double_t zMin, zMax;    // [cm]
+        Double_t step;          // node spacing [cm]
+        Double_t fieldChecksum; // R3BGTPCFieldCache::GetChecksum of the field, set by Build
+    };
+
+    /** Default constructor **/
+    R3BGTPCDriftTable();
+
+    /** Integrates the drift from every node; par.fieldChecksum is taken from field **/
+    void Build(const R3BGTPCFieldCache& field, const Parameters& par);
+
+    /** Writes the table to a binary file **/
+    Bool_t Write(const char* fileName) const;
+
+    /** Reads the table from a binary file, kFALSE if missing or built for other parameters or another field **/
+    Bool_t Read(const char* fileName, const Parameters& par, const R3BGTPCFieldCache& field);
+
+    Bool_t IsInitialized() const { return !fDx.empty(); }
+
+    /** Mean displacement dx, dz [cm], drift time [ns] and widths sigmaTransv [cm], sigmaTime [ns]
+     * for an electron starting at (x,y,z) [cm]; points outside the grid take the closest face **/
+    void Lookup(Double_t x,
+                Double_t y,
+                Double_t z,
+                Double_t& dx,
+                Double_t& dz,
+                Double_t& time,
+                Double_t& sigmaTransv,
+                Double_t& sigmaTime) const;
+
+  private:
+    void SetGrid(const Parameters& par);
+
+    Parameters fPar;                   //!< Parameters of the table
+    Int_t fNx, fNy, fNz;               //!< Grid nodes in each direction (at least 2)
+    Double_t fStepX, fStepY, fStepZ;   //!< Node spacing [cm]
+    std::vector<Float_t> fDx;          //!< Mean displacement in x [cm], [(iz * fNy + iy) * fNx + ix]
+    std::vector<Float_t> fDz;          //!< Mean displacement in z [cm]
+    std::vector<Float_t> fTime;        //!< Drift time [ns]
+    std::vector<Float_t> fSigmaTransv; //!< Transversal width at the pad plane [cm]
+    std::vector<Float_t> fSigmaTime;   //!< Arrival time width [ns]
+};
+
+#endif // R3BGTPCDRIFTTABLE_H
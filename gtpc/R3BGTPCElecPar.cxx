@@ -24,6 +24,7 @@
 // ---- Standard Constructor ----------------------------------------------
 R3BGTPCElecPar::R3BGTPCElecPar(const char* name, const char* title, const char* context)
     : FairParGenericSet(name, title, context)
+    , DriftStepTolerance(0.)
 {
 }
 
@@ -53,6 +54,7 @@ void R3BGTPCElecPar::putParams(FairParamList* list)
     list->add("GTPCThreshold", Threshold);
     list->add("GTPCDriftEField", DriftEField);
     list->add("GTPCDriftTimeStep", DriftTimeStep);
+    list->add("GTPCDriftStepTolerance", DriftStepTolerance);
 }
 
 // ----  Method getParams ------------------------------------------------------
@@ -103,6 +105,12 @@ Bool_t R3BGTPCElecPar::getParams(FairParamList* list)
         LOG(info) << "---Could not initialize GTPCDriftTimeStep";
         return kFALSE;
     }
+    // optional, not in the older parameter files
+    if (!(list->fill("GTPCDriftStepTolerance", &DriftStepTolerance)))
+    {
+        LOG(info) << "---No GTPCDriftStepTolerance, using a fixed drift time step";
+        DriftStepTolerance = 0.;
+    }
 
     return kTRUE;
 }
@@ -122,7 +130,8 @@ void R3BGTPCElecPar::printParams()
               << "GTPCShapingTime " << ShapingTime << " ns, "
               << "GTPCThreshold " << Threshold << " times noise rms, "
               << "GTPCDriftEField " << DriftEField << " V/cm, "
-              << "GTPCDriftTimeStep " << DriftTimeStep << " ns" << endl;
+              << "GTPCDriftTimeStep " << DriftTimeStep << " ns, "
+              << "GTPCDriftStepTolerance " << DriftStepTolerance << " kG" << endl;
 }
 
 ClassImp(R3BGTPCElecPar);
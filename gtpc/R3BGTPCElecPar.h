@@ -54,6 +54,7 @@ class R3BGTPCElecPar : public FairParGenericSet
     const Double_t GetThreshold() { return Threshold; }
     const Double_t GetDriftEField() { return DriftEField; }
     const Double_t GetDriftTimeStep() { return DriftTimeStep; }
+    const Double_t GetDriftStepTolerance() { return DriftStepTolerance; }
 
     void SetGain(Double_t value) { Gain = value; }
     void SetTheta(Double_t value) { Theta = value; }
@@ -63,21 +64,23 @@ class R3BGTPCElecPar : public FairParGenericSet
     void SetThreshold(Double_t value) { Threshold = value; }
     void SetDriftEField(Double_t value) { DriftEField = value; }
     void SetDriftTimeStep(Double_t value) { DriftTimeStep = value; }
+    void SetDriftStepTolerance(Double_t value) { DriftStepTolerance = value; }
 
   private:
-    Double_t Gain;          //
-    Double_t Theta;         //
-    Double_t NoiseRMS;      //
-    Double_t TimeBinSize;   // [ns]
-    Double_t ShapingTime;   //
-    Double_t Threshold;     //
-    Double_t DriftEField;   // [V/cm]
-    Double_t DriftTimeStep; // [ns]
+    Double_t Gain;               //
+    Double_t Theta;              //
+    Double_t NoiseRMS;           //
+    Double_t TimeBinSize;        // [ns]
+    Double_t ShapingTime;        //
+    Double_t Threshold;          //
+    Double_t DriftEField;        // [V/cm]
+    Double_t DriftTimeStep;      // [ns]
+    Double_t DriftStepTolerance; // [kG] field change along an adaptive drift step, 0 for a fixed step
 
     const R3BGTPCElecPar& operator=(const R3BGTPCElecPar&); /*< an assignment operator>*/
     R3BGTPCElecPar(const R3BGTPCElecPar&);                  /*< a copy constructor >*/
 
-    ClassDef(R3BGTPCElecPar, 1)
+    ClassDef(R3BGTPCElecPar, 2)
 };
 
 #endif
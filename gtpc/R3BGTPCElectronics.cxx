@@ -0,0 +1,418 @@
+/******************************************************************************
+ *   Copyright (C) 2019 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2019 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+#include "FairLogger.h"
+#include "FairRootManager.h"
+#include "FairRun.h"
+#include "FairRuntimeDb.h"
+#include "TClonesArray.h"
+#include "TMath.h"
+#include "TRandom.h"
+
+#include "R3BGTPCElectronics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const Double_t kElectronCharge = 1.60217e-4; // [fC]
+
+    // Standard normal random number above a (Marsaglia's exponential rejection in the tail)
+    Double_t GausAbove(Double_t a)
+    {
+        if (a <= 0.)
+        {
+            Double_t z;
+            do
+                z = gRandom->Gaus();
+            while (z <= a);
+            return z;
+        }
+        Double_t x, y;
+        do
+        {
+            x = -std::log(gRandom->Rndm()) / a;
+            y = -std::log(gRandom->Rndm());
+        } while (2. * y < x * x);
+        return a + x;
+    }
+} // namespace
+
+R3BGTPCElectronics::R3BGTPCElectronics()
+    : FairTask("R3BGTPCElectronics")
+    , fHalfSizeTPC_Y(0.)
+    , fDriftVelocity(0.)
+    , fGain(0.)
+    , fTheta(0.)
+    , fNoiseRMS(0.)
+    , fTimeBinSize(0.)
+    , fShapingTime(0.)
+    , fThreshold(0.)
+    , fInputTimeBinSize(0.)
+    , fInputTimeScale(1.)
+    , fDynamicRange(120.)
+    , fADCOffset(100.)
+    , fADCConversion(0.)
+    , fThresholdADC(0.)
+    , fNumSamples(0)
+    , fInputMode(1)
+    , fNoisePads(kFALSE)
+    , fNoiseSampleProb(0.)
+    , fNoisePadProb(0.)
+    , fGTPCGeoPar(NULL)
+    , fGTPCGasPar(NULL)
+    , fGTPCElecPar(NULL)
+    , fInputCA(NULL)
+    , fMappedCA(NULL)
+    , fOnline(kFALSE)
+{
+}
+
+R3BGTPCElectronics::~R3BGTPCElectronics()
+{
+    LOG(info) << "R3BGTPCElectronics: Delete instance";
+    if (fMappedCA)
+        delete fMappedCA;
+}
+
+void R3BGTPCElectronics::SetParContainers()
+{
+    FairRun* run = FairRun::Instance();
+    if (!run)
+    {
+        LOG(fatal) << "R3BGTPCElectronics::SetParContainers: No run";
+        return;
+    }
+    FairRuntimeDb* rtdb = run->GetRuntimeDb();
+    if (!rtdb)
+    {
+        LOG(fatal) << "R3BGTPCElectronics::SetParContainers: No runtime database";
+        return;
+    }
+
+    fGTPCGeoPar = (R3BGTPCGeoPar*)rtdb->getContainer("GTPCGeoPar");
+    if (!fGTPCGeoPar)
+    {
+        LOG(fatal) << "R3BGTPCElectronics::SetParContainers: No R3BGTPCGeoPar";
+        return;
+    }
+    fGTPCGasPar = (R3BGTPCGasPar*)rtdb->getContainer("GTPCGasPar");
+    if (!fGTPCGasPar)
+    {
+        LOG(fatal) << "R3BGTPCElectronics::SetParContainers: No R3BGTPCGasPar";
+        return;
+    }
+    fGTPCElecPar = (R3BGTPCElecPar*)rtdb->getContainer("GTPCElecPar");
+    if (!fGTPCElecPar)
+    {
+        LOG(fatal) << "R3BGTPCElectronics::SetParContainers: No R3BGTPCElecPar";
+        return;
+    }
+}
+
+void R3BGTPCElectronics::SetParameter()
+{
+    fHalfSizeTPC_Y = fGTPCGeoPar->GetActiveRegiony() / 2.; // [cm]
+    fDriftVelocity = fGTPCGasPar->GetDriftVelocity();      // [cm/ns]
+    fGain = fGTPCElecPar->GetGain();
+    fTheta = fGTPCElecPar->GetTheta();
+    fNoiseRMS = fGTPCElecPar->GetNoiseRMS();       // [electrons]
+    fTimeBinSize = fGTPCElecPar->GetTimeBinSize(); // [ns]
+    fShapingTime = fGTPCElecPar->GetShapingTime(); // [ns]
+    fThreshold = fGTPCElecPar->GetThreshold();     // [NoiseRMS]
+
+    if (fTimeBinSize <= 0. || fShapingTime <= 0. || fDriftVelocity <= 0.)
+        LOG(fatal) << "R3BGTPCElectronics::SetParameter: TimeBinSize, ShapingTime and DriftVelocity must be positive";
+    if (fTheta <= -1.)
+        LOG(fatal) << "R3BGTPCElectronics::SetParameter: Polya theta must be larger than -1";
+
+    Double_t inputTimeBinSize = fInputTimeBinSize;
+    if (inputTimeBinSize <= 0.)
+        inputTimeBinSize = fInputMode == 1 ? kProjPointTimeBinSize : fTimeBinSize;
+    fInputTimeScale = inputTimeBinSize / fTimeBinSize;
+    fADCConversion = kADCChannels / (fDynamicRange / kElectronCharge);
+    fThresholdADC = fThreshold * fNoiseRMS * fADCConversion + fADCOffset;
+
+    // full drift time plus the tail of the response
+    fNumSamples = (Int_t)std::ceil((2 * fHalfSizeTPC_Y / fDriftVelocity + kResponseLength * fShapingTime) / fTimeBinSize);
+
+    // AGET response to one electron, sampled from its arrival
+    Int_t responseSamples = (Int_t)std::ceil(kResponseLength * fShapingTime / fTimeBinSize) + 1;
+    fResponse.resize(responseSamples);
+    for (Int_t m = 0; m < responseSamples; m++)
+    {
+        Double_t u = m * fTimeBinSize / fShapingTime;
+        fResponse[m] = kResponseNorm * std::exp(-3. * u) * std::sin(u) * u * u * u;
+    }
+    fSignal.resize(fNumSamples);
+    fADC.resize(fNumSamples);
+
+    // noise over threshold: one sample, and at least one of the samples of a pad
+    fNoiseSampleProb = 0.5 * TMath::Erfc(fThreshold / TMath::Sqrt(2.));
+    fNoisePadProb = -std::expm1(fNumSamples * std::log1p(-fNoiseSampleProb));
+
+    // Pad plane, generated once per detector type and shared with the other tasks
+    fTPCMap = R3BGTPCMapRegistry::Get(fGTPCGeoPar->GetDetectorType());
+    fPadUsed.assign(fTPCMap->GetNumPads(), 0);
+    fUsedPads.clear();
+
+    LOG(info) << "R3BGTPCElectronics: " << fNumSamples << " samples of " << fTimeBinSize << " ns, response over "
+              << responseSamples << " samples, threshold " << fThresholdADC << " ADC channels";
+    if (fNoisePads)
+        LOG(info) << "R3BGTPCElectronics: noise over threshold in " << fNoisePadProb * 100.
+                  << " % of the pads without electrons";
+}
+
+InitStatus R3BGTPCElectronics::Init()
+{
+    LOG(info) << "R3BGTPCElectronics::Init() ";
+
+    FairRootManager* ioManager = FairRootManager::Instance();
+    if (!ioManager)
+    {
+        LOG(fatal) << "Init: No FairRootManager";
+        return kFATAL;
+    }
+
+    if (fInputMode == 0)
+    {
+        fInputCA = (TClonesArray*)ioManager->GetObject("GTPCCalData");
+        if (!fInputCA)
+        {
+            LOG(fatal) << "Init: No R3BGTPCCalData";
+            return kFATAL;
+        }
+    }
+    else
+    {
+        fInputCA = (TClonesArray*)ioManager->GetObject("GTPCProjPoint");
+        if (!fInputCA)
+        {
+            LOG(fatal) << "Init: No R3BGTPCProjPoint";
+            return kFATAL;
+        }
+    }
+
+    // Register output - Mapped
+    fMappedCA = new TClonesArray("R3BGTPCMappedData", 50);
+    ioManager->Register("GTPCMappedData", "GTPC Mapped", fMappedCA, !fOnline);
+
+    SetParameter();
+
+    return kSUCCESS;
+}
+
+InitStatus R3BGTPCElectronics::ReInit()
+{
+    SetParContainers();
+    SetParameter();
+    return kSUCCESS;
+}
+
+void R3BGTPCElectronics::Exec(Option_t* opt)
+{
+    Reset(); // Reset entries in output arrays, local arrays
+
+    Int_t nInputs = fInputCA->GetEntriesFast();
+    if (fInputMode == 0)
+    {
+        for (Int_t i = 0; i < nInputs; i++)
+        {
+            R3BGTPCCalData* cal = (R3BGTPCCalData*)fInputCA->At(i);
+            for (Int_t isample = 0; isample < cal->GetNumSamples(); isample++)
+                AddElectrons(cal->GetPadId(), cal->GetBucket(isample) + 0.5, cal->GetSample(isample));
+        }
+    }
+    else
+    {
+        const Double_t binWidth = (R3BGTPCTimeDistribution::kTimeMax - R3BGTPCTimeDistribution::kTimeMin) /
+                                  R3BGTPCTimeDistribution::kNumBins;
+        for (Int_t i = 0; i < nInputs; i++)
+        {
+            R3BGTPCProjPoint* point = (R3BGTPCProjPoint*)fInputCA->At(i);
+            const R3BGTPCTimeDistribution* distr = point->GetTimeDistribution();
+            for (Int_t bin = 0; bin <= R3BGTPCTimeDistribution::kNumBins + 1; bin++)
+            {
+                Double_t electrons = distr->GetBinContent(bin);
+                if (electrons <= 0.)
+                    continue;
+                // under and overflow at the range limits, the others at the bin center
+                Double_t time = R3BGTPCTimeDistribution::kTimeMin +
+                                TMath::Min(TMath::Max(bin - 0.5, 0.), (Double_t)R3BGTPCTimeDistribution::kNumBins) *
+                                    binWidth;
+                AddElectrons(point->GetVirtualPadID(), time, electrons);
+            }
+        }
+    }
+
+    // pads one after the other, samples in increasing order
+    std::sort(fDeposits.begin(), fDeposits.end());
+    size_t first = 0;
+    for (size_t i = 1; i <= fDeposits.size(); i++)
+    {
+        if (i == fDeposits.size() || fDeposits[i].pad != fDeposits[first].pad)
+        {
+            Int_t pad = fDeposits[first].pad;
+            if (pad >= 0 && pad < (Int_t)fPadUsed.size())
+            {
+                fPadUsed[pad] = 1;
+                fUsedPads.push_back(pad);
+            }
+            ProcessPad(first, i);
+            first = i;
+        }
+    }
+
+    if (fNoisePads)
+        AddNoisePads();
+    LOG(debug) << "R3BGTPCElectronics: " << fMappedCA->GetEntriesFast() << " pads over threshold";
+}
+
+void R3BGTPCElectronics::AddElectrons(Int_t pad, Double_t time, Double_t electrons)
+{
+    Int_t sample = (Int_t)(time * fInputTimeScale);
+    if (sample < 0)
+        sample = 0;
+    else if (sample > fNumSamples - 1)
+        sample = fNumSamples - 1;
+    fDeposits.push_back({ pad, sample, electrons });
+}
+
+void R3BGTPCElectronics::ProcessPad(size_t first, size_t last)
+{
+    std::fill(fSignal.begin(), fSignal.end(), 0.);
+
+    // discrete convolution, only over the samples where electrons arrive
+    const Int_t responseSamples = fResponse.size();
+    size_t i = first;
+    while (i < last)
+    {
+        Int_t sample = fDeposits[i].sample;
+        Double_t electrons = 0.;
+        for (; i < last && fDeposits[i].sample == sample; i++)
+            electrons += fDeposits[i].electrons;
+        Double_t charge = PolyaGain(electrons);
+        Int_t end = TMath::Min(responseSamples, fNumSamples - sample);
+        Double_t* signal = &fSignal[sample];
+        for (Int_t m = 0; m < end; m++)
+            signal[m] += charge * fResponse[m];
+    }
+
+    // noise, offset and ADC
+    Double_t max = 0.;
+    for (Int_t j = 0; j < fNumSamples; j++)
+    {
+        Double_t adc = (fSignal[j] + gRandom->Gaus(0., fNoiseRMS)) * fADCConversion + fADCOffset;
+        max = TMath::Max(max, adc);
+        fADC[j] = (UShort_t)TMath::Min(TMath::Max(TMath::Nint(adc), 0), kADCChannels - 1); // saturation
+    }
+
+    if (max > fThresholdADC)
+        AddMappedData(fDeposits[first].pad, fADC);
+}
+
+void R3BGTPCElectronics::AddNoisePads()
+{
+    Int_t numPads = fPadUsed.size();
+    Int_t numFree = numPads - fUsedPads.size();
+    if (numFree <= 0 || fNoisePadProb <= 0.)
+        return;
+
+    Int_t numNoisePads = gRandom->Binomial(numFree, fNoisePadProb);
+    for (Int_t i = 0; i < numNoisePads; i++)
+    {
+        Int_t pad;
+        do
+            pad = gRandom->Integer(numPads);
+        while (fPadUsed[pad]);
+        fPadUsed[pad] = 1;
+        fUsedPads.push_back(pad);
+
+        NoiseOverThreshold(pad);
+        AddMappedData(pad, fADC);
+    }
+}
+
+void R3BGTPCElectronics::NoiseOverThreshold(Int_t pad)
+{
+    // first sample over threshold j, P(j) proportional to (1 - p)^j for j < fNumSamples
+    Int_t firstOver = 0;
+    if (fNoiseSampleProb < 1.)
+        firstOver = (Int_t)(std::log1p(-gRandom->Rndm() * fNoisePadProb) / std::log1p(-fNoiseSampleProb));
+    firstOver = TMath::Min(firstOver, fNumSamples - 1);
+
+    for (Int_t j = 0; j < fNumSamples; j++)
+    {
+        Double_t z; // [NoiseRMS]
+        if (j < firstOver)
+        {
+            do
+                z = gRandom->Gaus();
+            while (z > fThreshold);
+        }
+        else if (j == firstOver)
+            z = GausAbove(fThreshold);
+        else
+            z = gRandom->Gaus();
+        Double_t adc = z * fNoiseRMS * fADCConversion + fADCOffset;
+        fADC[j] = (UShort_t)TMath::Min(TMath::Max(TMath::Nint(adc), 0), kADCChannels - 1);
+    }
+}
+
+Double_t R3BGTPCElectronics::PolyaGain(Double_t n) const
+{
+    return fGain / (fTheta + 1.) * RandomGamma(n * (fTheta + 1.));
+}
+
+Double_t R3BGTPCElectronics::RandomGamma(Double_t shape)
+{
+    if (shape < 1.)
+        return RandomGamma(shape + 1.) * std::pow(gRandom->Rndm(), 1. / shape);
+
+    const Double_t d = shape - 1. / 3.;
+    const Double_t c = 1. / std::sqrt(9. * d);
+    while (true)
+    {
+        Double_t x = gRandom->Gaus();
+        Double_t v = 1. + c * x;
+        if (v <= 0.)
+            continue;
+        v = v * v * v;
+        Double_t u = gRandom->Rndm();
+        if (std::log(u) < 0.5 * x * x + d - d * v + d * std::log(v))
+            return d * v;
+    }
+}
+
+void R3BGTPCElectronics::Finish() {}
+
+void R3BGTPCElectronics::Reset()
+{
+    LOG(debug) << "Clearing MappedData Structure";
+    if (fMappedCA)
+        fMappedCA->Clear("C");
+    fDeposits.clear();
+    for (auto pad : fUsedPads)
+        fPadUsed[pad] = 0;
+    fUsedPads.clear();
+}
+
+R3BGTPCMappedData* R3BGTPCElectronics::AddMappedData(Int_t pad, const std::vector<UShort_t>& adc)
+{
+    // It fills the R3BGTPCMappedData
+    TClonesArray& clref = *fMappedCA;
+    Int_t size = clref.GetEntriesFast();
+    return new (clref[size]) R3BGTPCMappedData(pad, adc, kTRUE, kFALSE);
+}
+
+ClassImp(R3BGTPCElectronics)
@@ -0,0 +1,189 @@
+/******************************************************************************
+ *   Copyright (C) 2019 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2019 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCElectronics.h
+ * AGET electronics response: Micromegas gain, shaping, noise and digitization
+ * of the electrons reaching the pad plane
+ **/
+#ifndef R3BGTPCELECTRONICS_H
+#define R3BGTPCELECTRONICS_H
+
+#include "FairTask.h"
+#include "R3BGTPCCalData.h"
+#include "R3BGTPCElecPar.h"
+#include "R3BGTPCGasPar.h"
+#include "R3BGTPCGeoPar.h"
+#include "R3BGTPCMapRegistry.h"
+#include "R3BGTPCMappedData.h"
+#include "R3BGTPCProjPoint.h"
+
+#include <vector>
+
+class TClonesArray;
+
+/**
+ * GTPC AGET electronics task
+ *
+ * For each event, takes the electrons collected in the pads and produces the
+ * sampled signal of the pads over threshold
+ *   Input:  Branch GTPCProjPoint = TClonesArray("R3BGTPCProjPoint") (default)
+ *           or Branch GTPCCalData = TClonesArray("R3BGTPCCalData")
+ *   Output: Branch GTPCMappedData = TClonesArray("R3BGTPCMappedData")
+ *
+ * The electrons are counted per pad and time sample (GTPCElecPar TimeBinSize).
+ * The Polya gain of the n electrons of a sample is drawn at once (the sum of n
+ * Polya gains of parameter theta is a Gamma distribution of shape n*(theta+1)).
+ * The signal is the discrete convolution of the amplified charge with the AGET
+ * response sampled once per run, plus the ADC offset and a Gaussian noise of
+ * NoiseRMS electrons per sample, converted to 12 bit ADC channels. Pads whose
+ * maximum exceeds Threshold * NoiseRMS above the offset are written.
+ * The time bins of the input are the ones of the task producing it: 1000 ns
+ * by default for the ProjPoint input (R3BGTPCProjector writes the time in us),
+ * the GTPCElecPar TimeBinSize by default for the CalData input; the CalData of
+ * R3BGTPCProjector need SetInputTimeBinSize(1000.).
+ *
+ * With SetNoisePads, the pads without electrons are written when their noise
+ * alone crosses the threshold. Their noise is not simulated sample by sample:
+ * a sample exceeds the threshold with p = erfc(Threshold / sqrt(2)) / 2, a pad
+ * with probability P = 1 - (1 - p)^samples, so the number of noise pads is
+ * drawn from a binomial over the untouched pads and only the chosen pads get a
+ * trace, generated conditioned on crossing the threshold (first crossing sample
+ * from a truncated geometric distribution, earlier samples below and that one
+ * above the threshold, later samples free).
+ */
+class R3BGTPCElectronics : public FairTask
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCElectronics();
+
+    /** Destructor **/
+    ~R3BGTPCElectronics();
+
+    /** Virtual method Exec **/
+    virtual void Exec(Option_t* opt);
+
+    /** Virtual method Reset **/
+    virtual void Reset();
+
+    /** Virtual method SetParContainers **/
+    virtual void SetParContainers();
+
+    /** Virtual method Init **/
+    virtual InitStatus Init();
+
+    /** Virtual method ReInit **/
+    virtual InitStatus ReInit();
+
+    /** Virtual method Finish **/
+    virtual void Finish();
+
+    /** Accessor to select online mode **/
+    void SetOnline(Bool_t option) { fOnline = option; }
+
+    void SetProjPointsAsInput() { fInputMode = 1; }
+    void SetCalDataAsInput() { fInputMode = 0; }
+
+    /** Writes the pads without electrons whose noise crosses the threshold (default kFALSE) **/
+    void SetNoisePads(Bool_t option) { fNoisePads = option; }
+
+    /** Time bin of the input [ns]; 0 (default) takes kProjPointTimeBinSize for the ProjPoint input and the
+     *  GTPCElecPar TimeBinSize for the CalData input **/
+    void SetInputTimeBinSize(Double_t binSize) { fInputTimeBinSize = binSize; }
+
+    /** Charge at full scale [fC] and ADC offset [channels] **/
+    void SetADCParameters(Double_t dynamicRange, Double_t offset)
+    {
+        fDynamicRange = dynamicRange;
+        fADCOffset = offset;
+    }
+
+    static const Int_t kADCChannels = 4096;                  //!< 12 bit ADC
+    static constexpr Double_t kResponseLength = 6.;          //!< Length of the AGET response [shaping times]
+    static constexpr Double_t kResponseNorm = 22.68113723;   //!< Normalization of the AGET response
+    static constexpr Double_t kProjPointTimeBinSize = 1000.; //!< Time unit of R3BGTPCProjPoint [ns]
+
+  private:
+    void SetParameter();
+
+    /** Electrons of one pad and time sample **/
+    struct Deposit
+    {
+        Int_t pad;
+        Int_t sample;
+        Double_t electrons;
+        bool operator<(const Deposit& other) const
+        {
+            return pad < other.pad || (pad == other.pad && sample < other.sample);
+        }
+    };
+
+    /** Adds the electrons arriving at pad at time [input time bins] **/
+    void AddElectrons(Int_t pad, Double_t time, Double_t electrons);
+    /** Signal of the pad with the deposits [first, last) of fDeposits, written if over threshold **/
+    void ProcessPad(size_t first, size_t last);
+    /** Draws the untouched pads whose noise crosses the threshold and writes their traces **/
+    void AddNoisePads();
+    /** Noise of a pad without electrons, conditioned on crossing the threshold [channels] **/
+    void NoiseOverThreshold(Int_t pad);
+    /** Total Polya gain of n electrons **/
+    Double_t PolyaGain(Double_t n) const;
+    /** Gamma distributed random number of the given shape and unit scale (Marsaglia-Tsang) **/
+    static Double_t RandomGamma(Double_t shape);
+
+    Double_t fHalfSizeTPC_Y;    //!< Half size Y of the TPC drift volume [cm]
+    Double_t fDriftVelocity;    //!< Drift velocity in gas [cm/ns]
+    Double_t fGain;             //!< Mean Micromegas gain
+    Double_t fTheta;            //!< Polya theta parameter
+    Double_t fNoiseRMS;         //!< Noise per sample [electrons]
+    Double_t fTimeBinSize;      //!< Sampling period [ns]
+    Double_t fShapingTime;      //!< AGET shaping time [ns]
+    Double_t fThreshold;        //!< Threshold [NoiseRMS]
+    Double_t fInputTimeBinSize; //!< Time bin of the input [ns], 0 for the default of the input mode
+    Double_t fInputTimeScale;   //!< Samples per input time bin
+    Double_t fDynamicRange;     //!< Charge at full scale [fC]
+    Double_t fADCOffset;        //!< ADC offset [channels]
+    Double_t fADCConversion;    //!< ADC channels per electron
+    Double_t fThresholdADC;     //!< Readout threshold [channels]
+    Int_t fNumSamples;          //!< Samples per pad
+    Int_t fInputMode;           //!< Selects Cal(0) or ProjPoint(1) as input. Default 1
+    Bool_t fNoisePads;          //!< Writes the untouched pads crossing the threshold
+    Double_t fNoiseSampleProb;  //!< Probability of a noise sample over threshold
+    Double_t fNoisePadProb;     //!< Probability of an untouched pad over threshold
+
+    R3BGTPCGeoPar* fGTPCGeoPar;   //!< Geometry parameter container
+    R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
+    R3BGTPCElecPar* fGTPCElecPar; //!< Electronic parameter container
+
+    std::shared_ptr<const R3BGTPCMap> fTPCMap; //!< Map container, shared (R3BGTPCMapRegistry)
+
+    TClonesArray* fInputCA;  //!< GTPCProjPoint or GTPCCalData
+    TClonesArray* fMappedCA; //!< GTPCMappedData
+
+    Bool_t fOnline; // Selector for online data storage
+
+    // buffers kept from event to event
+    std::vector<Double_t> fResponse; //!< AGET response to one electron, per sample after its arrival
+    std::vector<Deposit> fDeposits;  //!< Electrons of the event per pad and sample
+    std::vector<Double_t> fSignal;   //!< Signal of the current pad [electrons]
+    std::vector<UShort_t> fADC;      //!< Digitized signal of the current pad
+    std::vector<UChar_t> fPadUsed;   //!< Pads with a trace in the current event
+    std::vector<Int_t> fUsedPads;    //!< Their list, to clear fPadUsed
+
+    /** Private method AddMappedData**/
+    //** Adds a MappedData to the MappedCollection
+    R3BGTPCMappedData* AddMappedData(Int_t pad, const std::vector<UShort_t>& adc);
+
+    ClassDef(R3BGTPCElectronics, 1)
+};
+
+#endif // R3BGTPCELECTRONICS_H
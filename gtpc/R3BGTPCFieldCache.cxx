@@ -0,0 +1,126 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+#include "R3BGTPCFieldCache.h"
+
+#include "FairField.h"
+#include "FairLogger.h"
+
+#include <cmath>
+
+R3BGTPCFieldCache::R3BGTPCFieldCache()
+    : fNx(0)
+    , fNy(0)
+    , fNz(0)
+    , fXMin(0.)
+    , fYMin(0.)
+    , fZMin(0.)
+    , fInvStepX(0.)
+    , fInvStepY(0.)
+    , fInvStepZ(0.)
+    , fSpacing(0.)
+{
+}
+
+void R3BGTPCFieldCache::Init(FairField* field,
+                             Double_t xMin,
+                             Double_t xMax,
+                             Double_t yMin,
+                             Double_t yMax,
+                             Double_t zMin,
+                             Double_t zMax,
+                             Double_t step)
+{
+    // at least two nodes (one cell) in each direction
+    fNx = std::max(2, (Int_t)std::ceil((xMax - xMin) / step) + 1);
+    fNy = std::max(2, (Int_t)std::ceil((yMax - yMin) / step) + 1);
+    fNz = std::max(2, (Int_t)std::ceil((zMax - zMin) / step) + 1);
+    fXMin = xMin;
+    fYMin = yMin;
+    fZMin = zMin;
+    Double_t stepX = (xMax - xMin) / (fNx - 1);
+    Double_t stepY = (yMax - yMin) / (fNy - 1);
+    Double_t stepZ = (zMax - zMin) / (fNz - 1);
+    fInvStepX = stepX > 0 ? 1. / stepX : 0.;
+    fInvStepY = stepY > 0 ? 1. / stepY : 0.;
+    fInvStepZ = stepZ > 0 ? 1. / stepZ : 0.;
+    Double_t maxInvStep = std::max(fInvStepX, std::max(fInvStepY, fInvStepZ));
+    fSpacing = maxInvStep > 0 ? 1. / maxInvStep : step;
+
+    Int_t nNodes = fNx * fNy * fNz;
+    fBx.assign(nNodes, 0.);
+    fBy.assign(nNodes, 0.);
+    fBz.assign(nNodes, 0.);
+    fGrad.assign(nNodes, 0.);
+
+    if (!field)
+    {
+        LOG(warn) << "R3BGTPCFieldCache::Init: No field, using B=0";
+        return;
+    }
+
+    Int_t node = 0;
+    for (Int_t iz = 0; iz < fNz; iz++)
+        for (Int_t iy = 0; iy < fNy; iy++)
+            for (Int_t ix = 0; ix < fNx; ix++)
+            {
+                Double_t x = xMin + ix * stepX;
+                Double_t y = yMin + iy * stepY;
+                Double_t z = zMin + iz * stepZ;
+                fBx[node] = field->GetBx(x, y, z);
+                fBy[node] = field->GetBy(x, y, z);
+                fBz[node] = field->GetBz(x, y, z);
+                node++;
+            }
+
+    // gradient norm from the differences to the next node in each direction (previous one at the last node)
+    node = 0;
+    for (Int_t iz = 0; iz < fNz; iz++)
+        for (Int_t iy = 0; iy < fNy; iy++)
+            for (Int_t ix = 0; ix < fNx; ix++)
+            {
+                Int_t neighbour[3] = { ix < fNx - 1 ? node + 1 : node - 1,
+                                       iy < fNy - 1 ? node + fNx : node - fNx,
+                                       iz < fNz - 1 ? node + fNx * fNy : node - fNx * fNy };
+                Double_t invStep[3] = { fInvStepX, fInvStepY, fInvStepZ };
+                Double_t grad2 = 0.;
+                for (Int_t d = 0; d < 3; d++)
+                {
+                    Double_t dBx = (fBx[neighbour[d]] - fBx[node]) * invStep[d];
+                    Double_t dBy = (fBy[neighbour[d]] - fBy[node]) * invStep[d];
+                    Double_t dBz = (fBz[neighbour[d]] - fBz[node]) * invStep[d];
+                    grad2 += dBx * dBx + dBy * dBy + dBz * dBz;
+                }
+                fGrad[node] = std::sqrt(grad2);
+                node++;
+            }
+
+    LOG(info) << "R3BGTPCFieldCache::Init: field sampled in " << fNx << "x" << fNy << "x" << fNz << " nodes";
+}
+
+UInt_t R3BGTPCFieldCache::GetChecksum() const
+{
+    UInt_t hash = 2166136261u;
+    auto add = [&hash](const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 16777619u;
+    };
+    Int_t grid[3] = { fNx, fNy, fNz };
+    Double_t origin[3] = { fXMin, fYMin, fZMin };
+    add(grid, sizeof(grid));
+    add(origin, sizeof(origin));
+    for (auto array : { &fBx, &fBy, &fBz })
+        add(array->data(), array->size() * sizeof(Float_t));
+    return hash;
+}
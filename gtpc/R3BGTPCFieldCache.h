@@ -0,0 +1,129 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCFieldCache.h
+ * Magnetic field sampled on a regular grid covering the TPC drift volume
+ **/
+#ifndef R3BGTPCFIELDCACHE_H
+#define R3BGTPCFIELDCACHE_H
+
+#include "Rtypes.h"
+
+#include <algorithm>
+#include <vector>
+
+class FairField;
+
+/**
+ * GTPC field cache
+ *
+ * The field (GLAD map) is sampled once by Init on a regular grid covering the
+ * given box, stored as one array per component. GetField returns the three
+ * components from a single trilinear interpolation, in the units of the
+ * sampled field ([kG] for FairField). Points outside of the box take the value
+ * at the closest box face, so the box should include some margin around the
+ * region where the field is used. GetGradient gives a bound of the field
+ * variation around a point, used to adapt the drift time step.
+ */
+class R3BGTPCFieldCache
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCFieldCache();
+
+    /** Samples field in [xMin,xMax]x[yMin,yMax]x[zMin,zMax] [cm] with nodes every step [cm] (or
+     * closer). A null field gives a zero field **/
+    void Init(FairField* field,
+              Double_t xMin,
+              Double_t xMax,
+              Double_t yMin,
+              Double_t yMax,
+              Double_t zMin,
+              Double_t zMax,
+              Double_t step = 0.5);
+
+    Bool_t IsInitialized() const { return !fBx.empty(); }
+
+    /** Smallest node spacing [cm]; GetGradient is valid over this distance **/
+    Double_t GetSpacing() const { return fSpacing; }
+
+    /** Fingerprint of the grid and the sampled field values (32 bit FNV-1a), computed on each call **/
+    UInt_t GetChecksum() const;
+
+    /** Field components at (x,y,z) [cm] **/
+    inline void GetField(Double_t x, Double_t y, Double_t z, Double_t& bx, Double_t& by, Double_t& bz) const
+    {
+        Int_t ix, iy, iz;
+        Double_t tx = Locate(x, fXMin, fInvStepX, fNx, ix);
+        Double_t ty = Locate(y, fYMin, fInvStepY, fNy, iy);
+        Double_t tz = Locate(z, fZMin, fInvStepZ, fNz, iz);
+
+        // the eight corners of the cell, same weights for the three components
+        Int_t i000 = (iz * fNy + iy) * fNx + ix;
+        Int_t i100 = i000 + 1;
+        Int_t i010 = i000 + fNx;
+        Int_t i110 = i010 + 1;
+        Int_t i001 = i000 + fNx * fNy;
+        Int_t i101 = i001 + 1;
+        Int_t i011 = i001 + fNx;
+        Int_t i111 = i011 + 1;
+        Double_t w000 = (1 - tx) * (1 - ty) * (1 - tz);
+        Double_t w100 = tx * (1 - ty) * (1 - tz);
+        Double_t w010 = (1 - tx) * ty * (1 - tz);
+        Double_t w110 = tx * ty * (1 - tz);
+        Double_t w001 = (1 - tx) * (1 - ty) * tz;
+        Double_t w101 = tx * (1 - ty) * tz;
+        Double_t w011 = (1 - tx) * ty * tz;
+        Double_t w111 = tx * ty * tz;
+
+        bx = w000 * fBx[i000] + w100 * fBx[i100] + w010 * fBx[i010] + w110 * fBx[i110] + w001 * fBx[i001] +
+             w101 * fBx[i101] + w011 * fBx[i011] + w111 * fBx[i111];
+        by = w000 * fBy[i000] + w100 * fBy[i100] + w010 * fBy[i010] + w110 * fBy[i110] + w001 * fBy[i001] +
+             w101 * fBy[i101] + w011 * fBy[i011] + w111 * fBy[i111];
+        bz = w000 * fBz[i000] + w100 * fBz[i100] + w010 * fBz[i010] + w110 * fBz[i110] + w001 * fBz[i001] +
+             w101 * fBz[i101] + w011 * fBz[i011] + w111 * fBz[i111];
+    }
+
+    /** Largest field gradient [field units/cm] at the corners of the cell containing (x,y,z) [cm] **/
+    inline Double_t GetGradient(Double_t x, Double_t y, Double_t z) const
+    {
+        Int_t ix, iy, iz;
+        Locate(x, fXMin, fInvStepX, fNx, ix);
+        Locate(y, fYMin, fInvStepY, fNy, iy);
+        Locate(z, fZMin, fInvStepZ, fNz, iz);
+        Int_t i000 = (iz * fNy + iy) * fNx + ix;
+        Float_t grad = 0.;
+        for (Int_t i : { i000, i000 + fNx, i000 + fNx * fNy, i000 + fNx * fNy + fNx })
+            grad = std::max(grad, std::max(fGrad[i], fGrad[i + 1]));
+        return grad;
+    }
+
+  private:
+    /** Lower node of the cell containing v (clamped to the grid) and fractional position in the cell **/
+    static inline Double_t Locate(Double_t v, Double_t vMin, Double_t invStep, Int_t n, Int_t& i)
+    {
+        Double_t u = std::min(std::max((v - vMin) * invStep, 0.), (Double_t)(n - 1));
+        i = std::min((Int_t)u, n - 2);
+        return u - i;
+    }
+
+    Int_t fNx, fNy, fNz;                      //!< Grid nodes in each direction (at least 2)
+    Double_t fXMin, fYMin, fZMin;             //!< Grid origin [cm]
+    Double_t fInvStepX, fInvStepY, fInvStepZ; //!< Inverse of the node spacing [1/cm]
+    Double_t fSpacing;                        //!< Smallest node spacing [cm]
+    std::vector<Float_t> fBx;                 //!< Bx at the nodes [(iz * fNy + iy) * fNx + ix]
+    std::vector<Float_t> fBy;                 //!< By at the nodes
+    std::vector<Float_t> fBz;                 //!< Bz at the nodes
+    std::vector<Float_t> fGrad;               //!< Norm of the field gradient at the nodes (forward differences)
+};
+
+#endif // R3BGTPCFIELDCACHE_H
@@ -27,6 +27,7 @@
 #include "graph.h"
 #include "output.h"
 #include "pointcloud.h"
+#include "pointtree.h"
 #include "option.h"
 
 // R3BGTPCHit2Track: Constructor
@@ -37,6 +38,9 @@ R3BGTPCHit2Track::R3BGTPCHit2Track()
     , fHitCA(NULL)
     , fTrackCA(NULL)
     , fOnline(kFALSE)
+    , fSparseRadius(0.)
+    , fSparseDnn(kTRUE)
+    , fNumThreads(1)
 {
 }
 
@@ -126,8 +130,11 @@ void R3BGTPCHit2Track::Exec(Option_t* opt)
     // }
 
     Opt opt_params;
+    opt_params.set_sparse(fSparseRadius, fSparseDnn);
+    opt_params.set_threads(fNumThreads);
 	int opt_verbose = opt_params.get_verbosity(); 
-	PointCloud cloud_xyz;
+	// points as separate arrays, without a cluster set per point
+	PointArrays cloud_xyz;
 	fTrackFinder->eventToClusters(fHitCA,cloud_xyz); 
 	
 	if (cloud_xyz.size() == 0) {
@@ -136,8 +143,11 @@ void R3BGTPCHit2Track::Exec(Option_t* opt)
 	  
 	}
 
+	// kd-tree shared by the dnn and the smoothing (and the triplets if not smoothed)
+	PointTree tree(cloud_xyz);
+
 	if (opt_params.needs_dnn()) {
-	  double dnn = std::sqrt(first_quartile(cloud_xyz));
+	  double dnn = std::sqrt(first_quartile(cloud_xyz, tree));
 	  if (opt_verbose > 0) {
 	    std::cout << "[Info] computed dnn: " << dnn << std::endl;
 	  }
@@ -150,19 +160,23 @@ void R3BGTPCHit2Track::Exec(Option_t* opt)
 	}
 
         // Step 1) smoothing by position averaging of neighboring points
-	PointCloud cloud_xyz_smooth;
-	smoothen_cloud(cloud_xyz, cloud_xyz_smooth, opt_params.get_r());
+	PointArrays cloud_xyz_smooth;
+	smoothen_cloud(cloud_xyz, cloud_xyz_smooth, opt_params.get_r(), tree);
+	if (opt_params.get_r() != 0)
+	  tree.build(cloud_xyz_smooth);
 
     // Step 2) finding triplets of approximately collinear points
 	std::vector<triplet> triplets;
-	generate_triplets(cloud_xyz_smooth, triplets, opt_params.get_k(), opt_params.get_n(), opt_params.get_a());
+	generate_triplets(cloud_xyz_smooth, tree, triplets, opt_params.get_k(), opt_params.get_n(), opt_params.get_a(),
+			  opt_params.get_threads());
 
     // Step 3) single link hierarchical clustering of the triplets
     cluster_group cl_group;
     if (cloud_xyz_smooth.size() < 10)
         return;
-    compute_hc(cloud_xyz_smooth, cl_group, triplets, opt_params.get_s(), opt_params.get_t(), opt_params.is_tauto(),
-		   opt_params.get_dmax(), opt_params.is_dmax(), opt_params.get_linkage(), opt_verbose);
+    compute_hc(cl_group, triplets, opt_params.get_s(), opt_params.get_t(), opt_params.is_tauto(),
+		   opt_params.get_dmax(), opt_params.is_dmax(), opt_params.get_linkage(), opt_verbose,
+		   opt_params.is_sparse() ? opt_params.get_sparse() : 0.0, opt_params.get_threads());
 
     // Step 4) pruning by removal of small clusters ...
 	cleanup_cluster_group(cl_group, opt_params.get_m(), opt_verbose);
@@ -178,7 +192,7 @@ void R3BGTPCHit2Track::Exec(Option_t* opt)
 
 	        
         // store cluster labels in points
-	add_clusters(cloud_xyz, cl_group, opt_params.is_gnuplot());
+	add_clusters(cloud_xyz, cl_group);
     
 	// Adapt clusters to AtTrack
     fTrackFinder->clustersToTrack(cloud_xyz, cl_group, fTrackCA, fHitCA);
@@ -50,6 +50,17 @@ class R3BGTPCHit2Track : public FairTask
     /** Accessor to select online mode **/
     void SetOnline(Bool_t option) { fOnline = option; }
 
+    /** Sparse single linkage of the triplets closer than radius (<= 0, default, for the full distance matrix),
+     *  in units of the dNN of the event unless dnnMultiple is kFALSE **/
+    void SetSparseRadius(Double_t radius, Bool_t dnnMultiple = kTRUE)
+    {
+        fSparseRadius = radius;
+        fSparseDnn = dnnMultiple;
+    }
+
+    /** Threads for the triplets and their distance matrix (default 1, 0 for all hardware threads) **/
+    void SetNumThreads(Int_t nThreads) { fNumThreads = nThreads; }
+
   private:
     void SetParameter();
 
@@ -63,6 +74,10 @@ class R3BGTPCHit2Track : public FairTask
 
     Bool_t fOnline; // Selector for online data storage
 
+    Double_t fSparseRadius; // Triplet center distance for sparse clustering, <= 0 for none
+    Bool_t fSparseDnn;      // Whether fSparseRadius is a multiple of the dNN
+    Int_t fNumThreads;      // Threads for the triplets and the distance matrix
+
     /** Private method AddTrackData**/
     //** Adds a Track to the TrackCollection
     // R3BGTPCTrackData* AddTrackData(std::size_t trackId, std::vector<R3BGTPCHitData>&
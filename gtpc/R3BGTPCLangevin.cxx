@@ -15,15 +15,22 @@
 
 #include "FairLogger.h"
 #include "FairRootManager.h"
+#include "FairRun.h"
 #include "FairRunAna.h"
+#include "FairRunSim.h"
 #include "FairRuntimeDb.h"
-#include "R3BGladFieldMap.h"
 #include "TClonesArray.h"
 #include "TMath.h"
 #include "TVirtualMC.h"
 #include "TVirtualMCStack.h"
 
 #include "TF1.h"
+
+#include "R3BGTPCRandomStream.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
 using namespace std;
 
 R3BGTPCLangevin::R3BGTPCLangevin()
@@ -48,7 +55,11 @@ R3BGTPCLangevin::R3BGTPCLangevin()
     fDriftTimeStep = 0.;
     fDetectorType = 0;
     outputMode = 0;
-    fTPCMap = std::make_shared<R3BGTPCMap>();
+    fNumThreads = 0;
+    fRandomSeed = 0;
+    fDriftTableStep = 0.5;
+    fBatchDrift = kFALSE;
+    fMacroElectrons = 0;
 }
 
 R3BGTPCLangevin::~R3BGTPCLangevin()
@@ -77,10 +88,11 @@ R3BGTPCLangevin::~R3BGTPCLangevin()
 
 void R3BGTPCLangevin::SetParContainers()
 {
-    FairRunAna* run = FairRunAna::Instance();
+    // analysis run, or simulation run when digitizing during the transport
+    FairRun* run = FairRun::Instance();
     if (!run)
     {
-        LOG(fatal) << "R3BGTPCLangevin::SetParContainers: No analysis run";
+        LOG(fatal) << "R3BGTPCLangevin::SetParContainers: No run";
         return;
     }
     FairRuntimeDb* rtdb = run->GetRuntimeDb();
@@ -129,6 +141,45 @@ void R3BGTPCLangevin::SetParameter()
     fDriftEField = fGTPCElecPar->GetDriftEField();     // drift E field in V/cm
     fDriftTimeStep = fGTPCElecPar->GetDriftTimeStep(); // time step for drift params calculation
     fTimeBinSize = fGTPCElecPar->GetTimeBinSize();     // time step for drift params calculation
+
+    // Field sampled once over the drift volume, with 2 cm margin for the diffusion
+    FairField* field = FairRunAna::Instance() ? FairRunAna::Instance()->GetField() : nullptr;
+    if (!field && FairRunSim::Instance())
+        field = FairRunSim::Instance()->GetField();
+    fFieldCache.Init(field,
+                     fOffsetX - 2.,
+                     fOffsetX + 2 * fHalfSizeTPC_X + 2.,
+                     -fHalfSizeTPC_Y - 2.,
+                     fHalfSizeTPC_Y + 2.,
+                     fOffsetZ - 2.,
+                     fOffsetZ + 2 * fHalfSizeTPC_Z + 2.);
+    fDriftKernel.Init(
+        &fFieldCache, fDriftVelocity, fDriftEField, fTransDiff, fLongDiff, fDriftTimeStep, -fHalfSizeTPC_Y);
+    fDriftKernel.SetStepTolerance(fGTPCElecPar->GetDriftStepTolerance());
+
+    if (!fDriftTableFile.IsNull())
+    {
+        R3BGTPCDriftTable::Parameters par;
+        par.driftVelocity = fDriftVelocity;
+        par.driftEField = fDriftEField;
+        par.transDiff = fTransDiff;
+        par.longDiff = fLongDiff;
+        par.driftTimeStep = fDriftTimeStep;
+        par.stepTolerance = fGTPCElecPar->GetDriftStepTolerance();
+        par.xMin = fOffsetX;
+        par.xMax = fOffsetX + 2 * fHalfSizeTPC_X;
+        par.yMin = -fHalfSizeTPC_Y;
+        par.yMax = fHalfSizeTPC_Y;
+        par.zMin = fOffsetZ;
+        par.zMax = fOffsetZ + 2 * fHalfSizeTPC_Z;
+        par.step = fDriftTableStep;
+        par.fieldChecksum = 0.; // set from fFieldCache
+        if (!fDriftTable.Read(fDriftTableFile, par, fFieldCache))
+        {
+            fDriftTable.Build(fFieldCache, par);
+            fDriftTable.Write(fDriftTableFile);
+        }
+    }
 }
 
 InitStatus R3BGTPCLangevin::Init()
@@ -168,8 +219,8 @@ InitStatus R3BGTPCLangevin::Init()
 
     SetParameter();
 
-    // Pad plane generation
-    fTPCMap->GeneratePadPlane();
+    // Pad plane, generated once per detector type and shared with the other tasks
+    fTPCMap = R3BGTPCMapRegistry::Get(fDetectorType);
     fPadPlane = fTPCMap->GetPadPlane();
 
     if (fPadPlane == NULL)
@@ -178,6 +229,12 @@ InitStatus R3BGTPCLangevin::Init()
         return kERROR;
     }
 
+    // Pad accumulator, allocated once for the whole run
+    fDigitizer.Init(fTPCMap->GetNumPads(), outputMode);
+    fThreadDigitizers.resize(std::max(fNumThreads - 1, 0));
+    for (auto& digitizer : fThreadDigitizers)
+        digitizer.Init(fTPCMap->GetNumPads(), outputMode);
+
     return kSUCCESS;
 }
 
@@ -203,30 +260,15 @@ void R3BGTPCLangevin::Exec(Option_t*)
         return;
     }
 
-    R3BGladFieldMap* gladField = (R3BGladFieldMap*)FairRunAna::Instance()->GetField();
     R3BGTPCPoint* aPoint;
     Int_t presentTrackID = -10; // control of the point trackID
     Double_t xPre, yPre, zPre;
-    Double_t xPost, yPost, zPost;
-    Double_t projX, projZ, projTime;
-    Double_t energyDep = 0.;
-    Double_t timeBeforeDrift = 0.;
     Bool_t readyToProject = kFALSE;
-    Bool_t padFound = kFALSE;
-    Int_t electrons = 0;
-    Int_t flucElectrons = 0;
-    Int_t generatedElectrons = 0;
-    Double_t stepX, stepY, stepZ;
-    Double_t driftDistance, driftTime;
-    Double_t sigmaLongAtPadPlane;
-    Double_t sigmaTransvAtPadPlane;
-    Int_t evtID;
-    Int_t PDGCode, MotherId;
-    Double_t Vertex_x0, Vertex_y0, Vertex_z0, Vertex_px0, Vertex_py0, Vertex_pz0;
+    R3BGTPCDigitizer::TrackInfo track;
+    fSegments.clear();
     for (Int_t i = 0; i < nPoints; i++)
     {
         aPoint = (R3BGTPCPoint*)fGTPCPointsCA->At(i);
-        evtID = aPoint->GetEventID();
         if (aPoint->GetTrackStatus() == 11000 || aPoint->GetTrackStatus() == 10010010 ||
             aPoint->GetTrackStatus() == 10010000 || aPoint->GetTrackStatus() == 10011000)
         {
@@ -237,14 +279,16 @@ void R3BGTPCLangevin::Exec(Option_t*)
             yPre = aPoint->GetY();
             zPre = aPoint->GetZ();
             R3BMCTrack* Track = (R3BMCTrack*)fMCTrackCA->At(presentTrackID);
-            PDGCode = Track->GetPdgCode();
-            MotherId = Track->GetMotherId();
-            Vertex_x0 = Track->GetStartX();
-            Vertex_y0 = Track->GetStartY();
-            Vertex_z0 = Track->GetStartZ();
-            Vertex_px0 = Track->GetPx();
-            Vertex_py0 = Track->GetPy();
-            Vertex_pz0 = Track->GetPz();
+            // the first electron reaching a pad defines the track information of the R3BGTPCProjPoint
+            track.evtID = aPoint->GetEventID();
+            track.PDGCode = Track->GetPdgCode();
+            track.MotherId = Track->GetMotherId();
+            track.x0 = Track->GetStartX();
+            track.y0 = Track->GetStartY();
+            track.z0 = Track->GetStartZ();
+            track.px0 = Track->GetPx();
+            track.py0 = Track->GetPy();
+            track.pz0 = Track->GetPz();
             readyToProject = kTRUE;
             continue; // no energy deposited in this point, just taking in entrance coordinates
             // NOTE: the entering points deposit no energy but is used as start point for the calculation
@@ -266,224 +310,288 @@ void R3BGTPCLangevin::Exec(Option_t*)
             { // exiting the gas volume or dissappearing
                 readyToProject = kFALSE;
             }
-            // again from gMC->TrackPosition() for next point position
-            xPost = aPoint->GetX();
-            yPost = aPoint->GetY();
-            zPost = aPoint->GetZ();
-            energyDep = aPoint->GetEnergyLoss();
-            timeBeforeDrift = aPoint->GetTime(); // ns
         }
-        electrons = energyDep / fEIonization;
-        // electron number fluctuates as the square root of
-        // the Fano factor times the number of electrons
-        flucElectrons = pow(fFanoFactor * electrons, 0.5);
-        generatedElectrons = gRandom->Gaus(electrons, flucElectrons); // generated electrons
-
-        // step in each direction for an homogeneous electron creation position along the track
-        stepX = (xPost - xPre) / generatedElectrons;
-        stepY = (yPost - yPre) / generatedElectrons;
-        stepZ = (zPost - zPre) / generatedElectrons;
-
-        // taken a mean driftDistance for the calculation of the sigmaLong and sigmaTrans
-        // improve it by making the calculation individual for each electron, but probably slower
-        Double_t yApprox = (yPost + yPre) / 2;
-        driftDistance = yApprox + fHalfSizeTPC_Y;
-        sigmaLongAtPadPlane = sqrt(driftDistance * 2 * fLongDiff / fDriftVelocity);
-        sigmaTransvAtPadPlane = sqrt(driftDistance * 2 * fTransDiff / fDriftVelocity);
-
-        Double_t E_x = 0;
-        Double_t E_z = 0;
-        Double_t E_y = fDriftEField; // in V/m
-        Double_t B_x = 0;
-        Double_t B_y = 0;
-        Double_t B_z = 0;
-        Double_t moduleB = 0;
-        Double_t ele_x = 0;
-        Double_t ele_y = 0;
-        Double_t ele_z = 0;
-        Double_t vDrift_x = 0;
-        Double_t vDrift_y = 0;
-        Double_t vDrift_z = 0;
-        Double_t accDriftTime = 0;
-        Double_t cteMult = 0;
-        Double_t cteMod = 0;
-        Double_t productEB = 0;
-
-        Double_t sigmaLongStep;
-        Double_t sigmaTransvStep;
-        Double_t recoverDriftTimeStep = 0.;
-        Bool_t recoverStep = kTRUE;
-
-        Double_t mu = fDriftVelocity / E_y; // [cm^2 ns^-1 V^-1]
-
-        for (Int_t ele = 1; ele <= generatedElectrons; ele++)
+        // track portion between the previous point and this one, drifted below
+        DriftSegment segment;
+        segment.point = i;
+        segment.evtID = aPoint->GetEventID();
+        segment.xPre = xPre;
+        segment.yPre = yPre;
+        segment.zPre = zPre;
+        // again from gMC->TrackPosition() for next point position
+        segment.xPost = aPoint->GetX();
+        segment.yPost = aPoint->GetY();
+        segment.zPost = aPoint->GetZ();
+        segment.energyDep = aPoint->GetEnergyLoss();
+        segment.timeBeforeDrift = aPoint->GetTime(); // ns
+        segment.electrons = 0;
+        segment.track = track;
+        fSegments.push_back(segment);
+
+        xPre = segment.xPost;
+        yPre = segment.yPost;
+        zPre = segment.zPost;
+    }
+
+    if (fNumThreads < 1)
+    { // serial drift, all random numbers from gRandom
+        for (auto& segment : fSegments)
         {
-            //For a single electron
-            ele_x = xPre + stepX * ele; // homogeneous electron creation along the step [cm]
-            ele_y = yPre + stepY * ele;
-            ele_z = zPre + stepZ * ele;
-            accDriftTime = timeBeforeDrift;
-
-            LOG(debug) << "R3BGTPCLangevin::Exec, INITIAL VALUES: timeBeforeDrift=" << accDriftTime << " [ns]"
-                       << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
-            // cout   << "R3BGTPCLangevin::Exec, INITIAL VALUES: timeBeforeDrift=" << accDriftTime << " [ns]"
-            //                  << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
-            while (ele_y > -fHalfSizeTPC_Y)
-            { // while not reaching the pad plane [cm]
-                B_x = 1e4 *
-                      gladField->GetBx(ele_x, ele_y, ele_z); // Field components return in [kG], moved to [V ns cm^-2]
-                B_y = 1e4 * gladField->GetBy(ele_x, ele_y, ele_z);
-                B_z = 1e4 * gladField->GetBz(ele_x, ele_y, ele_z);
-                //std::cout << "MAGNETIC FIELD || Bx: "<<B_x<< " By: "<<B_y<<" Bz: "<<B_z<< '\n';
-
-                moduleB = TMath::Sqrt(B_x * B_x + B_y * B_y + B_z * B_z); // in [V ns cm^-2]
-                cteMod = 1 / (1 + mu * mu * moduleB * moduleB);           // adimensional
-                cteMult = mu * cteMod;                                    // [cm^2 V^-1 ns^-1]
-
-                // assuming only vertical electric field in the next four lines
-                productEB = E_y * B_y; // E_x*B_x + E_y*B_y + E_z*B_z; [V^2 ns cm^-3]
-
-                vDrift_x = cteMult * (mu * (E_y * B_z) +
-                                      mu * mu * productEB *
-                                          B_x); // cte * (Ex + mu*(E_y*B_z-E_z*B_y) + mu*mu*productEB*B_x); [cm/ns]
-                vDrift_y =
-                    cteMult * (E_y + mu * mu * productEB *
-                                         B_y); // cte * (Ey + mu*(E_z*B_x-E_x*B_z) + mu*mu*productEB*B_y); [cm/ns]
-                vDrift_z = cteMult * (mu * (-E_y * B_x) +
-                                      mu * mu * productEB *
-                                          B_z); // cte * (Ez + mu*(E_x*B_y-E_y*B_x) + mu*mu*productEB*B_z); [cm/ns]
-
-                LOG(debug) << "R3BGTPCLangevin::Exec, DRIFT VELOCITIES: vDrift_x=" << vDrift_x << " vDrift_y=" << vDrift_y
-                           << " vDrift_z=" << vDrift_z << " [cm/ns]";
-                // adjusting the last step before the pad plane
-                if (ele_y - vDrift_y * fDriftTimeStep < -fHalfSizeTPC_Y)
-                {
-                    if (recoverStep)
-                        recoverDriftTimeStep = fDriftTimeStep;
-                    recoverStep = kFALSE;
-                    fDriftTimeStep = (ele_y + fHalfSizeTPC_Y) / vDrift_y;
-                }
-
-                // reducing sigmaTransv (see http://web.ift.uib.no/~lipniack/detectors/lecture5/detector5.pdf)
-                // as B~B_y and E=E_y, let's simplify and apply the reduction to the transversal coefficient without
-                // projections
-                sigmaTransvStep =
-                    sqrt(fDriftTimeStep * 2 * fTransDiff * cteMod); // should be reduced by the factor cteMod=cteMult/mu
-                sigmaLongStep =
-                    sqrt(fDriftTimeStep * 2 * fLongDiff); // should be the same scaled to the length of the step
-                ele_x = gRandom->Gaus(ele_x + vDrift_x * fDriftTimeStep, sigmaTransvStep); // [cm]
-                ele_y = gRandom->Gaus(ele_y - vDrift_y * fDriftTimeStep, sigmaLongStep);   // [cm]
-                ele_z = gRandom->Gaus(ele_z + vDrift_z * fDriftTimeStep, sigmaTransvStep); // [cm]
-                accDriftTime = accDriftTime + fDriftTimeStep;                              //[ns]
-
-                // TODO!!! CHECK THE NEGATIVE sign in the y directions three lines above...
-                // Could it be symmetric with the others (+) in case the electric field is negative in Y?
-                // Does it change other cross terms? Which one is correct?
-
-                LOG(debug) << "R3BGTPCLangevin::Exec, NEW VALUES: accDriftTime=" << accDriftTime << " [ns]"
-                           << " ele_x=" << ele_x << " ele_y=" << ele_y << " ele_z=" << ele_z << " [cm]";
-            }
-            if (recoverDriftTimeStep)
+            segment.electrons = GenerateElectrons(segment.energyDep, *gRandom);
+            fDigitizer.SetTrackInfo(segment.track);
+            if (fMacroElectrons > 0)
             {
-                fDriftTimeStep = recoverDriftTimeStep;
-                recoverDriftTimeStep = 0.;
-                recoverStep = kTRUE;
+                for (Int_t cloud = 0; cloud < std::min(fMacroElectrons, segment.electrons); cloud++)
+                    DriftCloud(segment, cloud, *gRandom, fDigitizer);
             }
-            // FINAL RESULT: X,Z position and time of the electron after Langevin calculation:
-            projX = ele_x;
-            projZ = ele_z;
-            projTime = accDriftTime;
-
-            //Removing electrons out of pad plane limits
-            if (projZ < fOffsetZ || projZ > fOffsetZ + 2 * fHalfSizeTPC_Z || projX < fOffsetX || projX > fOffsetX + 2 * fHalfSizeTPC_X)
-                continue;
-
-            //Adding -1 to get padID between 0 - 5631
-            Int_t padID = fPadPlane->Fill((projZ - fOffsetZ) * 10.0, (projX - fOffsetX) * 10.0) - 1; // in mm for the padID
+            else if (fBatchDrift && !fDriftTable.IsInitialized())
+                DriftElectronBatches(segment, gRandom, fDigitizer);
+            else
+                DriftElectrons(segment, *gRandom, fDigitizer);
+        }
+    }
+    else
+    { // threaded drift, random streams for each (event, point, electron)
+        Long64_t totalElectrons = 0;
+        for (auto& segment : fSegments)
+        {
+            R3BGTPCRandomStream random(fRandomSeed, segment.evtID, segment.point, 0);
+            segment.electrons = GenerateElectrons(segment.energyDep, random);
+            totalElectrons += std::max(segment.electrons, 0);
+        }
 
-            //If returns negative padID means its filling overflow/underflow bins
-            //Maybe error in the conditionals projX and projZ above
-            if (padID < 0 || padID > 5631)
-            {
-                LOG(warn)<<"R3BGTPCLangevin::Exec No-valid padID" << endl;
-                continue;
-            }
+        // consecutive segments with a similar number of electrons for each thread; the thread
+        // accumulators are merged in the segment order, so the output does not depend on fNumThreads
+        std::vector<size_t> firstSegment(fNumThreads + 1, fSegments.size());
+        firstSegment[0] = 0;
+        Long64_t accElectrons = 0;
+        Int_t chunk = 1;
+        for (size_t s = 0; s < fSegments.size() && chunk < fNumThreads; s++)
+        {
+            accElectrons += std::max(fSegments[s].electrons, 0);
+            while (chunk < fNumThreads && accElectrons * fNumThreads >= totalElectrons * chunk)
+                firstSegment[chunk++] = s + 1;
+        }
 
-            if (outputMode == 0)
-            { // Output: TClonesArray of R3BGTPCCalData
-                Int_t nCalData = fGTPCCalDataCA->GetEntriesFast();
-                for (Int_t pp = 0; pp < nCalData; pp++)
-                {
-                    if (((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->GetPadId() == padID)
-                    {
-                        // already existing R3BGTPCCalData... add time and electron
-                        projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                        if (projTime < 0)
-                            projTime = 0; // Fills (first) underflow bin
-                        else if (projTime > 511)
-                            projTime = 511; // Fills (last) overflow bin
-                        ((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->SetADC(projTime);
-                        padFound = kTRUE;
-                        break;
-                    }
-
-                }
-                if (!padFound)
-                {
-                    std::vector<UShort_t> adc(512, 0);
-                    projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                    if (projTime < 0)
-                        projTime = 0; // Fills (first) underflow bin
-                    else if (projTime > 511)
-                        projTime = 511; // Fills (last) overflow bin
-                    adc.at(projTime)++;
-                    new ((*fGTPCCalDataCA)[nCalData]) R3BGTPCCalData(padID, adc);
-                }
-                padFound = kFALSE;
-            }
-            else if (outputMode == 1)
-            { // Output: TClonesArray of R3BGTPCProjPoint
-                Int_t nProjPoints = fGTPCProjPointCA->GetEntriesFast();
-                for (Int_t pp = 0; pp < nProjPoints; pp++)
-                {
-                    if (((R3BGTPCProjPoint*)fGTPCProjPointCA->At(pp))->GetVirtualPadID() == padID)
-                    {
-                        // already existing R3BGTPCProjPoint... add time and electron
-                        ((R3BGTPCProjPoint*)fGTPCProjPointCA->At(pp))->AddCharge();
-                        ((R3BGTPCProjPoint*)fGTPCProjPointCA->At(pp))
-                            ->SetTimeDistr(projTime / fTimeBinSize, 1); // micros
-                        padFound = kTRUE;
-                        break;
-                    }
-                }
-                if (!padFound)
-                {
-                    new ((*fGTPCProjPointCA)[nProjPoints]) R3BGTPCProjPoint(padID,
-                                                                            projTime / fTimeBinSize, // micros
-                                                                            1,
-                                                                            evtID,
-                                                                            PDGCode,
-                                                                            MotherId,
-                                                                            Vertex_x0,
-                                                                            Vertex_y0,
-                                                                            Vertex_z0,
-                                                                            Vertex_px0,
-                                                                            Vertex_py0,
-                                                                            Vertex_pz0);
-                }
-                padFound = kFALSE;
-            }
+        std::vector<std::thread> workers;
+        for (Int_t t = 1; t < fNumThreads; t++)
+            workers.emplace_back(&R3BGTPCLangevin::DriftSegments,
+                                 this,
+                                 firstSegment[t],
+                                 firstSegment[t + 1],
+                                 std::ref(fThreadDigitizers[t - 1]));
+        DriftSegments(firstSegment[0], firstSegment[1], fDigitizer);
+        for (Int_t t = 1; t < fNumThreads; t++)
+        {
+            workers[t - 1].join();
+            fDigitizer.Merge(fThreadDigitizers[t - 1]);
         }
-        xPre = xPost;
-        yPre = yPost;
-        zPre = zPost;
     }
+
+    if (outputMode == 0)
+        fDigitizer.Flush(fGTPCCalDataCA);
+    else if (outputMode == 1)
+        fDigitizer.Flush(fGTPCProjPointCA);
+
     if (outputMode == 0)
         LOG(info) << "R3BGTPCLangevin: produced " << fGTPCCalDataCA->GetEntries() << " R3BGTPCcalData(s)";
     if (outputMode == 1)
         LOG(info) << "R3BGTPCLangevin: produced " << fGTPCProjPointCA->GetEntries() << " R3BGTPCProjPoint(s)";
 }
 
+template <typename RNG>
+Int_t R3BGTPCLangevin::GenerateElectrons(Double_t energyDep, RNG& random) const
+{
+    Int_t electrons = energyDep / fEIonization;
+    // electron number fluctuates as the square root of
+    // the Fano factor times the number of electrons
+    Int_t flucElectrons = pow(fFanoFactor * electrons, 0.5);
+    return random.Gaus(electrons, flucElectrons); // generated electrons
+}
+
+template <typename RNG>
+void R3BGTPCLangevin::DriftElectrons(const DriftSegment& segment, RNG& random, R3BGTPCDigitizer& digitizer) const
+{
+    // step in each direction for an homogeneous electron creation position along the track
+    Double_t stepX = (segment.xPost - segment.xPre) / segment.electrons;
+    Double_t stepY = (segment.yPost - segment.yPre) / segment.electrons;
+    Double_t stepZ = (segment.zPost - segment.zPre) / segment.electrons;
+
+    for (Int_t ele = 1; ele <= segment.electrons; ele++)
+    {
+        //For a single electron
+        Double_t ele_x = segment.xPre + stepX * ele; // homogeneous electron creation along the step [cm]
+        Double_t ele_y = segment.yPre + stepY * ele;
+        Double_t ele_z = segment.zPre + stepZ * ele;
+        Double_t accDriftTime = segment.timeBeforeDrift;
+        DriftElectron(ele_x, ele_y, ele_z, accDriftTime, random);
+        DigitizeElectron(ele_x, ele_z, accDriftTime, digitizer);
+    }
+}
+
+template <typename RNG>
+void R3BGTPCLangevin::DriftCloud(const DriftSegment& segment,
+                                 Int_t cloud,
+                                 RNG& random,
+                                 R3BGTPCDigitizer& digitizer) const
+{
+    // electrons first..last of the track portion, centroid in the middle of them
+    Int_t nClouds = std::min(fMacroElectrons, segment.electrons);
+    Int_t first = cloud * segment.electrons / nClouds + 1;
+    Int_t last = (cloud + 1) * segment.electrons / nClouds;
+    Double_t center = 0.5 * (first + last) / segment.electrons;
+
+    Double_t ele_x = segment.xPre + (segment.xPost - segment.xPre) * center; // [cm]
+    Double_t ele_y = segment.yPre + (segment.yPost - segment.yPre) * center;
+    Double_t ele_z = segment.zPre + (segment.zPost - segment.zPre) * center;
+    Double_t accDriftTime = segment.timeBeforeDrift; // [ns]
+    Double_t sigmaTransv, sigmaTime;
+    if (fDriftTable.IsInitialized())
+    {
+        Double_t dx, dz, driftTime;
+        sigmaTransv = sigmaTime = 0.;
+        if (ele_y > -fHalfSizeTPC_Y)
+        {
+            fDriftTable.Lookup(ele_x, ele_y, ele_z, dx, dz, driftTime, sigmaTransv, sigmaTime);
+            ele_x += dx;
+            ele_z += dz;
+            accDriftTime += driftTime;
+        }
+    }
+    else
+        fDriftKernel.DriftCentroid(ele_x, ele_y, ele_z, accDriftTime, sigmaTransv, sigmaTime);
+
+    // charge of the cloud spread on the pads and time buckets
+    for (Int_t ele = first; ele <= last; ele++)
+    {
+        Double_t projX = random.Gaus(ele_x, sigmaTransv);
+        Double_t projZ = random.Gaus(ele_z, sigmaTransv);
+        Double_t projTime = random.Gaus(accDriftTime, sigmaTime);
+        DigitizeElectron(projX, projZ, projTime, digitizer);
+    }
+}
+
+void R3BGTPCLangevin::DriftElectronBatches(const DriftSegment& segment,
+                                           TRandom* random,
+                                           R3BGTPCDigitizer& digitizer) const
+{
+    const Int_t kBatchSize = R3BGTPCDriftKernel::kBatchSize;
+    Double_t ele_x[kBatchSize], ele_y[kBatchSize], ele_z[kBatchSize], accDriftTime[kBatchSize];
+    R3BGTPCRandomStream streams[kBatchSize]; // used when no generator is given
+
+    Double_t stepX = (segment.xPost - segment.xPre) / segment.electrons;
+    Double_t stepY = (segment.yPost - segment.yPre) / segment.electrons;
+    Double_t stepZ = (segment.zPost - segment.zPre) / segment.electrons;
+
+    for (Int_t first = 1; first <= segment.electrons; first += kBatchSize)
+    {
+        Int_t n = std::min(kBatchSize, segment.electrons - first + 1);
+        for (Int_t i = 0; i < n; i++)
+        {
+            ele_x[i] = segment.xPre + stepX * (first + i);
+            ele_y[i] = segment.yPre + stepY * (first + i);
+            ele_z[i] = segment.zPre + stepZ * (first + i);
+            accDriftTime[i] = segment.timeBeforeDrift;
+        }
+        if (random)
+            fDriftKernel.DriftBatch(n, ele_x, ele_y, ele_z, accDriftTime, random);
+        else
+        { // same streams (event, point, electron) as the electron by electron threaded drift
+            for (Int_t i = 0; i < n; i++)
+                streams[i] = R3BGTPCRandomStream(fRandomSeed, segment.evtID, segment.point, first + i);
+            fDriftKernel.DriftBatch(n, ele_x, ele_y, ele_z, accDriftTime, streams);
+        }
+        for (Int_t i = 0; i < n; i++)
+            DigitizeElectron(ele_x[i], ele_z[i], accDriftTime[i], digitizer);
+    }
+}
+
+void R3BGTPCLangevin::DriftSegments(size_t first, size_t last, R3BGTPCDigitizer& digitizer) const
+{
+    for (size_t s = first; s < last; s++)
+    {
+        const DriftSegment& segment = fSegments[s];
+        digitizer.SetTrackInfo(segment.track);
+        if (fMacroElectrons > 0)
+        {
+            for (Int_t cloud = 0; cloud < std::min(fMacroElectrons, segment.electrons); cloud++)
+            {
+                R3BGTPCRandomStream random(fRandomSeed, segment.evtID, segment.point, cloud + 1);
+                DriftCloud(segment, cloud, random, digitizer);
+            }
+            continue;
+        }
+        if (fBatchDrift && !fDriftTable.IsInitialized())
+        {
+            DriftElectronBatches(segment, nullptr, digitizer);
+            continue;
+        }
+
+        Double_t stepX = (segment.xPost - segment.xPre) / segment.electrons;
+        Double_t stepY = (segment.yPost - segment.yPre) / segment.electrons;
+        Double_t stepZ = (segment.zPost - segment.zPre) / segment.electrons;
+
+        for (Int_t ele = 1; ele <= segment.electrons; ele++)
+        {
+            R3BGTPCRandomStream random(fRandomSeed, segment.evtID, segment.point, ele);
+            Double_t ele_x = segment.xPre + stepX * ele;
+            Double_t ele_y = segment.yPre + stepY * ele;
+            Double_t ele_z = segment.zPre + stepZ * ele;
+            Double_t accDriftTime = segment.timeBeforeDrift;
+            DriftElectron(ele_x, ele_y, ele_z, accDriftTime, random);
+            DigitizeElectron(ele_x, ele_z, accDriftTime, digitizer);
+        }
+    }
+}
+
+template <typename RNG>
+void R3BGTPCLangevin::DriftElectron(Double_t& ele_x,
+                                    Double_t& ele_y,
+                                    Double_t& ele_z,
+                                    Double_t& accDriftTime,
+                                    RNG& random) const
+{
+    if (fDriftTable.IsInitialized())
+    { // one Gaussian per coordinate around the mean arrival point and time
+        if (ele_y <= -fHalfSizeTPC_Y)
+            return;
+        Double_t dx, dz, driftTime, sigmaTransv, sigmaTime;
+        fDriftTable.Lookup(ele_x, ele_y, ele_z, dx, dz, driftTime, sigmaTransv, sigmaTime);
+        ele_x = random.Gaus(ele_x + dx, sigmaTransv);                    // [cm]
+        ele_z = random.Gaus(ele_z + dz, sigmaTransv);                    // [cm]
+        accDriftTime = random.Gaus(accDriftTime + driftTime, sigmaTime); // [ns]
+        ele_y = -fHalfSizeTPC_Y;
+        return;
+    }
+
+    fDriftKernel.Drift(ele_x, ele_y, ele_z, accDriftTime, random);
+}
+
+void R3BGTPCLangevin::DigitizeElectron(Double_t projX,
+                                       Double_t projZ,
+                                       Double_t projTime,
+                                       R3BGTPCDigitizer& digitizer) const
+{
+    // FINAL RESULT: X,Z position and time of the electron after Langevin calculation
+    //Removing electrons out of pad plane limits
+    if (projZ < fOffsetZ || projZ > fOffsetZ + 2 * fHalfSizeTPC_Z || projX < fOffsetX ||
+        projX > fOffsetX + 2 * fHalfSizeTPC_X)
+        return;
+
+    //padID from the pad layout of the detector, in mm
+    Int_t padID = fTPCMap->PadIdFromPosition((projZ - fOffsetZ) * 10.0, (projX - fOffsetX) * 10.0);
+
+    //Negative padID means the electron is out of the pads (e.g. on the lower edges)
+    //Maybe error in the conditionals projX and projZ above
+    if (padID < 0 || padID > digitizer.GetNumPads() - 1)
+    {
+        LOG(warn) << "R3BGTPCLangevin::Exec No-valid padID";
+        return;
+    }
+
+    digitizer.AddElectron(padID, projTime / fTimeBinSize); // moving from ns to binsize
+}
+
 void R3BGTPCLangevin::Finish() {}
 
 ClassImp(R3BGTPCLangevin)
@@ -19,14 +19,18 @@
 
 #include "FairTask.h"
 #include "R3BGTPCCalData.h"
+#include "R3BGTPCDigitizer.h"
+#include "R3BGTPCDriftKernel.h"
+#include "R3BGTPCDriftTable.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
 #include "R3BGTPCPoint.h"
 #include "R3BGTPCProjPoint.h"
 #include "TClonesArray.h"
 #include "TVirtualMC.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCMapRegistry.h"
 
 /**
  * GTPC drift calculation using Langevin equation task
@@ -67,6 +71,33 @@ class R3BGTPCLangevin : public FairTask
     void SetProjPointsAsOutput() { outputMode = 1; }
     void SetCalDataAsOutput() { outputMode = 0; }
 
+    /** Drift in n threads (to be set before Init). The random numbers come from streams
+     * keyed by (event, point, electron), so the output is the same for any n >= 1.
+     * n = 0 (default) keeps the serial drift with gRandom **/
+    void SetNumThreads(Int_t n) { fNumThreads = n; }
+    /** Seed of the random streams of the threaded drift **/
+    void SetRandomSeed(ULong64_t seed) { fRandomSeed = seed; }
+
+    /** Drift with a precomputed table (mean arrival point and time, diffusion widths) instead of
+     * the step by step integration. The table is read from fileName, or built with nodes every
+     * step [cm] and written there if missing or built with other parameters **/
+    void SetDriftTable(TString fileName, Double_t step = 0.5)
+    {
+        fDriftTableFile = fileName;
+        fDriftTableStep = step;
+    }
+
+    /** Drift the electrons of each track portion in batches of R3BGTPCDriftKernel::kBatchSize
+     * (vectorizable step loop). Same physics as the electron by electron drift, but the random
+     * numbers are drawn in another order, so the output is only statistically equal **/
+    void SetBatchDrift(Bool_t batch = kTRUE) { fBatchDrift = batch; }
+
+    /** Macro-electron mode: the electrons of each track portion are grouped in n clouds; only the
+     * cloud centroids are drifted and the electrons of each cloud are spread around the arrival
+     * point and time with the diffusion widths accumulated along the path. Larger n is closer to
+     * the electron by electron drift, smaller n is faster. n = 0 (default) drifts every electron **/
+    void SetMacroElectrons(Int_t n) { fMacroElectrons = n; }
+
   private:
     // Mapping of  virtualPadID to ProjPoint object pointer
     // std::map<Int_t, R3BGTPCProjPoint*> fProjPointMap;
@@ -101,8 +132,47 @@ class R3BGTPCLangevin : public FairTask
 
     // R3BGTPCCalData* AddCalData();
 
-    std::shared_ptr<R3BGTPCMap> fTPCMap; //!< Map container
-    TH2Poly* fPadPlane;                  //!< Pad Plane object
+    std::shared_ptr<const R3BGTPCMap> fTPCMap; //!< Map container, shared (R3BGTPCMapRegistry)
+    const TH2Poly* fPadPlane;                  //!< Pad Plane object
+
+    R3BGTPCDigitizer fDigitizer;   //!< Per-event pad x time bucket accumulator
+    R3BGTPCFieldCache fFieldCache; //!< GLAD field sampled over the drift volume
+    R3BGTPCDriftKernel fDriftKernel; //!< Langevin step integration
+    Bool_t fBatchDrift;              //!< Drift the electrons in batches
+    Int_t fMacroElectrons;           //!< Electron clouds per track portion, 0 for single electrons
+    R3BGTPCDriftTable fDriftTable; //!< Drift table, used when filled
+    TString fDriftTableFile;       //!< File of the drift table, none for the step by step drift
+    Double_t fDriftTableStep;      //!< Node spacing of the drift table [cm]
+
+    // Track portion between two consecutive points of the same track
+    struct DriftSegment
+    {
+        Int_t point;                       // index of the end point in the input array
+        Int_t evtID;                       // MC event of the point
+        Double_t xPre, yPre, zPre;         // start position [cm]
+        Double_t xPost, yPost, zPost;      // end position [cm]
+        Double_t energyDep;                // energy deposited [GeV]
+        Double_t timeBeforeDrift;          // time of the end point [ns]
+        Int_t electrons;                   // generated electrons
+        R3BGTPCDigitizer::TrackInfo track; // track information for the R3BGTPCProjPoint
+    };
+
+    Int_t fNumThreads;                               //!< Threads for the drift, 0 for the serial drift with gRandom
+    ULong64_t fRandomSeed;                           //!< Seed of the random streams of the threaded drift
+    std::vector<DriftSegment> fSegments;             //!< Segments of the current event
+    std::vector<R3BGTPCDigitizer> fThreadDigitizers; //!< Accumulators of the threads other than the main one
+
+    template <typename RNG>
+    Int_t GenerateElectrons(Double_t energyDep, RNG& random) const;
+    template <typename RNG>
+    void DriftElectrons(const DriftSegment& segment, RNG& random, R3BGTPCDigitizer& digitizer) const;
+    template <typename RNG>
+    void DriftCloud(const DriftSegment& segment, Int_t cloud, RNG& random, R3BGTPCDigitizer& digitizer) const;
+    void DriftElectronBatches(const DriftSegment& segment, TRandom* random, R3BGTPCDigitizer& digitizer) const;
+    void DriftSegments(size_t first, size_t last, R3BGTPCDigitizer& digitizer) const;
+    template <typename RNG>
+    void DriftElectron(Double_t& ele_x, Double_t& ele_y, Double_t& ele_z, Double_t& accDriftTime, RNG& random) const;
+    void DigitizeElectron(Double_t projX, Double_t projZ, Double_t projTime, R3BGTPCDigitizer& digitizer) const;
 
     ClassDef(R3BGTPCLangevin, 2)
 };
@@ -226,6 +226,29 @@ void R3BGTPCLangevinTest::Exec(Option_t*)
 
     Double_t TargetAngle = 14. * 3.14159 / 180;
 
+    if (!fFieldCache.IsInitialized())
+    { // field sampled once over the box containing the rotated test volume, with 2 cm margin
+        Double_t xMin = 1e9, xMax = -1e9, zMin = 1e9, zMax = -1e9;
+        for (Double_t xLocal : { -fHalfSizeTPC_X, fHalfSizeTPC_X })
+            for (Double_t zLocal : { 0., 2 * fHalfSizeTPC_Z })
+            {
+                Double_t xCorner = cos(-TargetAngle) * xLocal + sin(-TargetAngle) * zLocal;
+                Double_t zCorner =
+                    (TargetOffsetZ_FM - fHalfSizeTPC_Z) - sin(-TargetAngle) * xLocal + cos(-TargetAngle) * zLocal;
+                xMin = std::min(xMin, xCorner);
+                xMax = std::max(xMax, xCorner);
+                zMin = std::min(zMin, zCorner);
+                zMax = std::max(zMax, zCorner);
+            }
+        fFieldCache.Init(gladField,
+                         xMin - 2.,
+                         xMax + 2.,
+                         -fHalfSizeTPC_Y - 2.,
+                         fHalfSizeTPC_Y + 2.,
+                         zMin - 2.,
+                         zMax + 2.);
+    }
+
     B_x = 0.1 * gladField->GetBx(0, 0, 163.4); // Field components return in [kG], moved to [T]
     B_y = 0.1 * gladField->GetBy(0, 0, 163.4);
     B_z = 0.1 * gladField->GetBz(0, 0, 163.4);
@@ -316,9 +339,10 @@ void R3BGTPCLangevinTest::Exec(Option_t*)
 
                 while (ele_y > -fHalfSizeTPC_Y)
                 {                                                      // while not reaching the pad plane [cm]
-                    B_x = 0.1 * gladField->GetBx(ele_x, ele_y, ele_z); // Field components return in [kG], moved to [T]
-                    B_y = 0.1 * gladField->GetBy(ele_x, ele_y, ele_z);
-                    B_z = 0.1 * gladField->GetBz(ele_x, ele_y, ele_z);
+                    fFieldCache.GetField(ele_x, ele_y, ele_z, B_x, B_y, B_z);
+                    B_x = 0.1 * B_x; // Field components return in [kG], moved to [T]
+                    B_y = 0.1 * B_y;
+                    B_z = 0.1 * B_z;
 
                     // if(ele==0) cout << "Field for (" << ele_x << "," << ele_y << "," << ele_z << ")" << B_x << " " <<
                     // B_y << " "  << B_z << " "  << endl;
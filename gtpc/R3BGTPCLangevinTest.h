@@ -19,6 +19,7 @@
 
 #include "FairTask.h"
 #include "R3BGTPCElecPar.h"
+#include "R3BGTPCFieldCache.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
 #include "R3BGTPCPoint.h"
@@ -91,6 +92,8 @@ class R3BGTPCLangevinTest : public FairTask
     R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
     R3BGTPCElecPar* fGTPCElecPar; //!< Electronic parameter container
 
+    R3BGTPCFieldCache fFieldCache; //!< GLAD field sampled over the test volume
+
     ClassDef(R3BGTPCLangevinTest, 1)
 };
 
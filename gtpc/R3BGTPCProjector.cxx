@@ -16,6 +16,7 @@
 
 #include "FairLogger.h"
 #include "FairRootManager.h"
+#include "FairRun.h"
 #include "FairRunAna.h"
 #include "FairRuntimeDb.h"
 #include "TF1.h"
@@ -43,7 +44,6 @@ R3BGTPCProjector::R3BGTPCProjector()
     fHalfSizeTPC_Z = 0.;
     fDetectorType = 0;
     outputMode = 0;
-    fTPCMap = std::make_shared<R3BGTPCMap>();
 }
 
 R3BGTPCProjector::~R3BGTPCProjector()
@@ -74,10 +74,11 @@ R3BGTPCProjector::~R3BGTPCProjector()
 
 void R3BGTPCProjector::SetParContainers()
 {
-    FairRunAna* run = FairRunAna::Instance();
+    // analysis run, or simulation run when digitizing during the transport
+    FairRun* run = FairRun::Instance();
     if (!run)
     {
-        LOG(fatal) << "R3BGTPCProjector::SetParContainers: No analysis run";
+        LOG(fatal) << "R3BGTPCProjector::SetParContainers: No run";
         return;
     }
     FairRuntimeDb* rtdb = run->GetRuntimeDb();
@@ -164,8 +165,8 @@ InitStatus R3BGTPCProjector::Init()
 
     SetParameter();
 
-    // Pad plane generation
-    fTPCMap->GeneratePadPlane();
+    // Pad plane, generated once per detector type and shared with the other tasks
+    fTPCMap = R3BGTPCMapRegistry::Get(fDetectorType);
     fPadPlane = fTPCMap->GetPadPlane();
 
     if (fPadPlane == NULL)
@@ -175,6 +176,9 @@ InitStatus R3BGTPCProjector::Init()
         return kERROR;
     }
 
+    // Pad accumulator, allocated once for the whole run
+    fDigitizer.Init(fTPCMap->GetNumPads(), outputMode);
+
     return kSUCCESS;
 }
 
@@ -230,7 +234,6 @@ void R3BGTPCProjector::Exec(Option_t*)
     Double_t energyDep = 0.;
     Double_t timeBeforeDrift = 0.;
     Bool_t readyToProject = kFALSE;
-    Bool_t padFound = kFALSE;
     Int_t electrons = 0;
     Int_t flucElectrons = 0;
     Int_t generatedElectrons = 0;
@@ -239,12 +242,12 @@ void R3BGTPCProjector::Exec(Option_t*)
     Double_t sigmaLongAtPadPlane;
     Double_t sigmaTransvAtPadPlane;
     Int_t evtID;
+    Int_t PDGCode, MotherId;
+    Double_t Vertex_x0, Vertex_y0, Vertex_z0, Vertex_px0, Vertex_py0, Vertex_pz0;
     for (Int_t i = 0; i < nPoints; i++)
     {
         aPoint = (R3BGTPCPoint*)fGTPCPoints->At(i);
         evtID = aPoint->GetEventID();
-        Int_t PDGCode, MotherId;
-        Double_t Vertex_x0, Vertex_y0, Vertex_z0, Vertex_px0, Vertex_py0, Vertex_pz0;
         if (aPoint->GetTrackStatus() == 11000 || aPoint->GetTrackStatus() == 10010010 ||
             aPoint->GetTrackStatus() == 10010000 || aPoint->GetTrackStatus() == 10011000)
         {
@@ -263,6 +266,9 @@ void R3BGTPCProjector::Exec(Option_t*)
             Vertex_px0 = Track->GetPx();
             Vertex_py0 = Track->GetPy();
             Vertex_pz0 = Track->GetPz();
+            // the first electron reaching a pad defines the track information of the R3BGTPCProjPoint
+            fDigitizer.SetTrackInfo(
+                evtID, PDGCode, MotherId, Vertex_x0, Vertex_y0, Vertex_z0, Vertex_px0, Vertex_py0, Vertex_pz0);
             readyToProject = kTRUE;
             continue; // no energy deposited in this point, just taking in entrance coordinates
         }
@@ -338,83 +344,17 @@ void R3BGTPCProjector::Exec(Option_t*)
             if (projX > XOffset + 2 * fHalfSizeTPC_X)
                 projX = XOffset + 2 * fHalfSizeTPC_X;
 
-	    //std::cout<<" proj Z "<<projZ<<" - proj Y "<<projY<<"\n";
-            Int_t padID = fPadPlane->Fill((projZ - ZOffset) * 10.0, (projX - XOffset) * 10.0); // in mm
-	    
-
-            // Deprecated code to remove
-            /*(if (fDetectorType == 1)
-                padID = (44) * (Int_t)((projZ - ZOffset) / 0.2) + (Int_t)((projX - XOffset) / 0.2); // 2mm
-            else
-                padID = (2 * fHalfSizeTPC_X * fSizeOfVirtualPad) * (Int_t)((projZ - ZOffset) * fSizeOfVirtualPad) +
-                        (Int_t)((projX - XOffset) * fSizeOfVirtualPad); // FULL HYDRA padplane has not been decided yet
-        */
-
-            if (outputMode == 0)
-            { // Output: TClonesArray of R3BGTPCCalData
-                Int_t nCalData = fGTPCCalDataCA->GetEntriesFast();
-                for (Int_t pp = 0; pp < nCalData; pp++)
-                {
-                    if (((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->GetPadId() == padID)
-                    {
-                        // already existing R3BGTPCCalData... add time and electron
-                        projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                        if (projTime < 0)
-                            projTime = 0; // Fills (first) underflow bin
-                        else if (projTime > 511)
-                            projTime = 511; // Fills (last) overflow bin
-                        ((R3BGTPCCalData*)fGTPCCalDataCA->At(pp))->SetADC(projTime);
-                        padFound = kTRUE;
-                        break;
-                    }
-                }
-                if (!padFound)
-                {
-                    std::vector<UShort_t> adc(512, 0);
-                    projTime = projTime / fTimeBinSize; // moving from ns to binsize
-                    if (projTime < 0)
-                        projTime = 0; // Fills (first) underflow bin
-                    else if (projTime > 511)
-                        projTime = 511; // Fills (last) overflow bin
-                    adc.at(projTime)++;
-
-                    new ((*fGTPCCalDataCA)[nCalData]) R3BGTPCCalData(padID, adc);
-                }
-                padFound = kFALSE;
-            }
-            else if (outputMode == 1)
+            // padID from the pad layout of the detector, as in R3BGTPCLangevin and R3BGTPCCal2Hit
+            Int_t padID = fTPCMap->PadIdFromPosition((projZ - ZOffset) * 10.0, (projX - XOffset) * 10.0); // in mm
+
+            // Negative padID means the projection is out of the pads (projections on the lower edges)
+            if (padID < 0 || padID > fDigitizer.GetNumPads() - 1)
             {
+                LOG(debug) << "R3BGTPCProjector::Exec No-valid padID";
+                continue;
+            }
 
-                Int_t nProjPoints = fGTPCProjPoint->GetEntriesFast();
-
-                for (Int_t pp = 0; pp < nProjPoints; pp++)
-                {
-                    if (((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->GetVirtualPadID() == padID)
-                    {
-                        // already existing R3BGTPCProjPoint... add time and electron
-                        ((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->AddCharge();                      //
-                        ((R3BGTPCProjPoint*)fGTPCProjPoint->At(pp))->SetTimeDistr(projTime / 1000, 1); // micros
-                        padFound = kTRUE;
-                        break;
-                    }
-                }
-                if (!padFound)
-                {
-                    new ((*fGTPCProjPoint)[nProjPoints]) R3BGTPCProjPoint(padID,
-                                                                          projTime / 1000, // micros
-                                                                          1,
-                                                                          evtID,
-                                                                          PDGCode,
-                                                                          MotherId,
-                                                                          Vertex_x0,
-                                                                          Vertex_y0,
-                                                                          Vertex_z0,
-                                                                          Vertex_px0,
-                                                                          Vertex_py0,
-                                                                          Vertex_pz0);
-                }
-                padFound = kFALSE;
-        }
+            fDigitizer.AddElectron(padID, projTime / fTimeBinSize); // moving from ns to binsize
         }
 
         xPre = xPost;
@@ -422,7 +362,16 @@ void R3BGTPCProjector::Exec(Option_t*)
         zPre = zPost;
 
     } // Simulated points
-    LOG(info) << "R3BGTPCProjector: produced " << fGTPCProjPoint->GetEntries() << " projPoints";
+    if (outputMode == 0)
+    {
+        fDigitizer.Flush(fGTPCCalDataCA);
+        LOG(info) << "R3BGTPCProjector: produced " << fGTPCCalDataCA->GetEntries() << " R3BGTPCCalData(s)";
+    }
+    else if (outputMode == 1)
+    {
+        fDigitizer.Flush(fGTPCProjPoint);
+        LOG(info) << "R3BGTPCProjector: produced " << fGTPCProjPoint->GetEntries() << " projPoints";
+    }
 }
 
 void R3BGTPCProjector::Finish() {}
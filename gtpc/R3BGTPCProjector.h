@@ -19,10 +19,11 @@
 
 #include "FairTask.h"
 #include "R3BGTPCCalData.h"
+#include "R3BGTPCDigitizer.h"
 #include "R3BGTPCElecPar.h"
 #include "R3BGTPCGasPar.h"
 #include "R3BGTPCGeoPar.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCMapRegistry.h"
 #include "R3BGTPCPoint.h"
 #include "R3BGTPCProjPoint.h"
 #include "TClonesArray.h"
@@ -102,8 +103,9 @@ class R3BGTPCProjector : public FairTask
     R3BGTPCGasPar* fGTPCGasPar;   //!< Gas parameter container
     R3BGTPCElecPar* fGTPCElecPar; //!< Electronics parameter container
 
-    std::shared_ptr<R3BGTPCMap> fTPCMap; //!< Map container
-    TH2Poly* fPadPlane;                  //!< Pad Plane object
+    std::shared_ptr<const R3BGTPCMap> fTPCMap; //!< Map container, shared (R3BGTPCMapRegistry)
+    const TH2Poly* fPadPlane;                  //!< Pad Plane object
+    R3BGTPCDigitizer fDigitizer;         //!< Per-event pad x time bucket accumulator
 
     ClassDef(R3BGTPCProjector, 1)
 };
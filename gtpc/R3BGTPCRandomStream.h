@@ -0,0 +1,84 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCRandomStream.h
+ * Counter-based random number stream for the digitization tasks
+ **/
+#ifndef R3BGTPCRANDOMSTREAM_H
+#define R3BGTPCRANDOMSTREAM_H
+
+#include "Rtypes.h"
+
+#include <cmath>
+
+/**
+ * GTPC counter-based random stream
+ *
+ * The n-th number of a stream is a hash of (key, n), the key being derived from
+ * a seed and three integers identifying the work item, e.g. (event, point, electron).
+ * A stream therefore gives the same sequence wherever and whenever it is used,
+ * which makes the output independent of the number of threads and of the order
+ * in which the work items are processed. Not suited for cryptography, only for
+ * simulation (SplitMix64 mixing function).
+ */
+class R3BGTPCRandomStream
+{
+  public:
+    R3BGTPCRandomStream()
+        : R3BGTPCRandomStream(0, 0, 0, 0)
+    {
+    }
+
+    R3BGTPCRandomStream(ULong64_t seed, ULong64_t a, ULong64_t b, ULong64_t c)
+        : fKey(Mix(seed ^ Mix(a + Mix(b + Mix(c)))))
+        , fCounter(0)
+        , fHasGaus(kFALSE)
+        , fGaus(0.)
+    {
+    }
+
+    /** Uniform number in (0,1) **/
+    inline Double_t Rndm() { return ((Next() >> 11) + 0.5) * (1. / 9007199254740992.); } // 2^53
+
+    /** Gaussian number (Box-Muller, the second number of each pair is kept for the next call) **/
+    inline Double_t Gaus(Double_t mean, Double_t sigma)
+    {
+        if (fHasGaus)
+        {
+            fHasGaus = kFALSE;
+            return mean + sigma * fGaus;
+        }
+        Double_t r = std::sqrt(-2. * std::log(Rndm()));
+        Double_t phi = 2. * M_PI * Rndm();
+        fGaus = r * std::sin(phi);
+        fHasGaus = kTRUE;
+        return mean + sigma * r * std::cos(phi);
+    }
+
+  private:
+    static inline ULong64_t Mix(ULong64_t z)
+    {
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    inline ULong64_t Next() { return Mix(fKey + (++fCounter) * 0x9E3779B97F4A7C15ULL); }
+
+    ULong64_t fKey;     //!< Stream key
+    ULong64_t fCounter; //!< Numbers drawn so far
+    Bool_t fHasGaus;    //!< A Gaussian number is kept
+    Double_t fGaus;     //!< Kept Gaussian number
+};
+
+#endif // R3BGTPCRANDOMSTREAM_H
@@ -13,16 +13,70 @@
 
 #include "R3BGTPCCalData.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 R3BGTPCCalData::R3BGTPCCalData()
     : fPadId(0)
-    , fADC(0)
+    , fNumBuckets(0)
+{
+}
+
+R3BGTPCCalData::R3BGTPCCalData(UShort_t padId, const std::vector<UShort_t>& adc)
+    : fPadId(padId)
+    , fNumBuckets(0)
 {
+    SetADC(adc);
 }
 
-R3BGTPCCalData::R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc)
+R3BGTPCCalData::R3BGTPCCalData(UShort_t padId, const UShort_t* adc, Int_t numBuckets)
     : fPadId(padId)
-    , fADC(adc)
+    , fNumBuckets(0)
+{
+    SetADC(adc, numBuckets);
+}
+
+void R3BGTPCCalData::SetADC(const UShort_t* adc, Int_t numBuckets)
+{
+    fNumBuckets = numBuckets;
+    fBuckets.clear();
+    fSamples.clear();
+    for (Int_t t = 0; t < numBuckets; t++)
+        if (adc[t] != 0)
+        {
+            fBuckets.push_back(t);
+            fSamples.push_back(adc[t]);
+        }
+}
+
+void R3BGTPCCalData::SetADC(Double_t time)
+{
+    if (time < 0 || time >= fNumBuckets)
+        throw std::out_of_range("R3BGTPCCalData::SetADC: time bucket out of range");
+    UShort_t bucket = (UShort_t)time;
+    auto it = std::lower_bound(fBuckets.begin(), fBuckets.end(), bucket);
+    Int_t i = it - fBuckets.begin();
+    if (it == fBuckets.end() || *it != bucket)
+    {
+        fBuckets.insert(it, bucket);
+        fSamples.insert(fSamples.begin() + i, 0);
+    }
+    fSamples[i]++;
+}
+
+std::vector<UShort_t> R3BGTPCCalData::GetADC() const
+{
+    std::vector<UShort_t> adc(fNumBuckets, 0);
+    for (size_t i = 0; i < fBuckets.size(); i++)
+        adc[fBuckets[i]] = fSamples[i];
+    return adc;
+}
+
+void R3BGTPCCalData::Clear(Option_t* /*option*/)
 {
+    fNumBuckets = 0;
+    std::vector<UShort_t>().swap(fBuckets);
+    std::vector<UShort_t>().swap(fSamples);
 }
 
 ClassImp(R3BGTPCCalData);
@@ -16,7 +16,18 @@
 
 #include "TObject.h"
 #include <stdint.h>
+#include <vector>
 
+/**
+ * GTPC calibrated pad data
+ *
+ * The time buckets are stored zero-suppressed, as (bucket, value) pairs of the
+ * non-zero buckets in increasing bucket order. The loops over the signal use
+ *   for (Int_t i = 0; i < cal->GetNumSamples(); i++)
+ *       ... cal->GetBucket(i) ... cal->GetSample(i) ...
+ * GetADC() builds the dense vector of GetNumBuckets() buckets on each call, so
+ * it is kept out of the loops over the pads. Version 1 files (dense fADC) are converted when read (R3BGTPCDataLinkDef.h).
+ */
 class R3BGTPCCalData : public TObject
 {
 
@@ -28,25 +39,39 @@ class R3BGTPCCalData : public TObject
      *@param padId               Crystal unique identifier
      *@param adc                 Calibrated adc energies
      **/
-    R3BGTPCCalData(UShort_t padId, std::vector<UShort_t> adc);
+    R3BGTPCCalData(UShort_t padId, const std::vector<UShort_t>& adc);
+
+    /** Constructor from the numBuckets time buckets adc[] of a digitizer, without copy **/
+    R3BGTPCCalData(UShort_t padId, const UShort_t* adc, Int_t numBuckets);
 
     // Destructor
     virtual ~R3BGTPCCalData() {}
 
     // Getters
     inline const UShort_t& GetPadId() const { return fPadId; }
-    inline const std::vector<UShort_t>& GetADC() const { return fADC; }
+    inline Int_t GetNumBuckets() const { return fNumBuckets; }
+    inline Int_t GetNumSamples() const { return fBuckets.size(); }
+    inline Int_t GetBucket(Int_t i) const { return fBuckets[i]; }
+    inline UShort_t GetSample(Int_t i) const { return fSamples[i]; }
+    std::vector<UShort_t> GetADC() const;
 
     // Setter
     void SetPadId(UShort_t padId) { fPadId = padId; }
-    void SetADC(Double_t time) { fADC.at(time)++; }
+    void SetADC(Double_t time);
+    void SetADC(const UShort_t* adc, Int_t numBuckets);
+    void SetADC(const std::vector<UShort_t>& adc) { SetADC(adc.data(), adc.size()); }
+
+    // Releases the time buckets before the TClonesArray slot is reused (Clear("C"))
+    void Clear(Option_t* option);
 
   protected:
-    UShort_t fPadId;            // Pad unique identifier
-    std::vector<UShort_t> fADC; // ADC measurements, variable time bucket
+    UShort_t fPadId;                // Pad unique identifier
+    UShort_t fNumBuckets;           // Number of time buckets, zeros included
+    std::vector<UShort_t> fBuckets; // Non-zero time buckets, increasing
+    std::vector<UShort_t> fSamples; // ADC measurements of the non-zero time buckets
 
   public:
-    ClassDef(R3BGTPCCalData, 1)
+    ClassDef(R3BGTPCCalData, 2)
 };
 
 #endif
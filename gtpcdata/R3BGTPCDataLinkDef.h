@@ -6,10 +6,20 @@
 #pragma link off all classes;
 #pragma link off all functions;
 
+#pragma link C++ class R3BGTPCStringTable + ;
 #pragma link C++ class R3BGTPCPoint + ;
+#pragma link C++ class R3BGTPCTimeDistribution + ;
 #pragma link C++ class R3BGTPCProjPoint + ;
+// version 1 stored the time distribution in a TH1S of the same binning
+#pragma read sourceClass="R3BGTPCProjPoint" version="[1]" targetClass="R3BGTPCProjPoint" \
+    source="TH1S* fTimeDistr" target="fTimeDistr" include="TH1S.h" \
+    code="{ if (onfile.fTimeDistr) { fTimeDistr.FromHistogram(*onfile.fTimeDistr); delete onfile.fTimeDistr; } }"
 #pragma link C++ class R3BGTPCMappedData + ;
 #pragma link C++ class R3BGTPCCalData + ;
+// version 1 stored all the time buckets
+#pragma read sourceClass="R3BGTPCCalData" version="[1]" targetClass="R3BGTPCCalData" \
+    source="std::vector<UShort_t> fADC" target="fNumBuckets,fBuckets,fSamples" \
+    code="{ newObj->SetADC(onfile.fADC); }"
 #pragma link C++ class R3BGTPCHitData + ;
 #pragma link C++ class R3BGTPCHitClusterData + ;
 #pragma link C++ class R3BGTPCTrackData + ;
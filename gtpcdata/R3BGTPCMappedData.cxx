@@ -32,4 +32,6 @@ R3BGTPCMappedData::R3BGTPCMappedData(UShort_t padId,
 {
 }
 
+void R3BGTPCMappedData::Clear(Option_t* option) { std::vector<UShort_t>().swap(fADC); }
+
 ClassImp(R3BGTPCMappedData);
@@ -41,6 +41,9 @@ class R3BGTPCMappedData : public TObject
     inline const Bool_t& IsValid() const { return fIsValid; }
     inline const Bool_t& IsPedestalSubtracted() const { return fIsPedestalSubtracted; }
 
+    // Releases the ADC measurements before the TClonesArray slot is reused (Clear("C"))
+    void Clear(Option_t* option);
+
   protected:
     UShort_t fPadId;              // Pad unique identifier
     std::vector<UShort_t> fADC;   // ADC measurements, variable time bucket
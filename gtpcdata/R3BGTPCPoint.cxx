@@ -25,6 +25,7 @@ R3BGTPCPoint::R3BGTPCPoint()
     fPDGCode = fModuleID = 0;
     fCharge = fMass = fKineticEnergy = fTrackStep = 0.0;
     fIsAccepted = kFALSE;
+    fParticleNameId = fVolNameId = fProcessNameId = -1;
 }
 // -------------------------------------------------------------------------
 
@@ -61,6 +62,9 @@ R3BGTPCPoint::R3BGTPCPoint(Int_t trackID,
     , fParticleName(particleName)
     , fVolName(volName)
     , fProcessName(processName)
+    , fParticleNameId(-1)
+    , fVolNameId(-1)
+    , fProcessNameId(-1)
     , fCharge(charge)
     , fMass(mass)
     , fKineticEnergy(kineticEnergy)
@@ -77,16 +81,16 @@ R3BGTPCPoint::~R3BGTPCPoint() {}
 // -----   Public method Print   -------------------------------------------
 void R3BGTPCPoint::Print(const Option_t* opt) const
 {
-    cout << "-I- R3BGTPCPoint: STS Point for track " << fTrackID << " in detector " << fDetectorID << " (" << fVolName
-         << "), copy " << fDetCopyID << endl;
+    cout << "-I- R3BGTPCPoint: STS Point for track " << fTrackID << " in detector " << fDetectorID << " ("
+         << GetVolName() << "), copy " << fDetCopyID << endl;
     cout << "    Position (" << fX << ", " << fY << ", " << fZ << ") cm" << endl;
     cout << "    Momentum (" << fPx << ", " << fPy << ", " << fPz << ") GeV" << endl;
     cout << "    Time " << fTime << " ns,  Length " << fLength << " cm,  Energy loss " << fELoss * 1.0e06 << " keV"
          << endl;
 
     cout << "    Specific GTPC Point info forEventID for track " << fTrackID << " with PDGCode " << fPDGCode << " ("
-         << fParticleName << "),"
-         << " suffering process " << fProcessName << endl
+         << GetParticleName() << "),"
+         << " suffering process " << GetProcessName() << endl
          << "    Mass " << fMass << ", charge " << fCharge << ", PDGCode " << fPDGCode << ", kinetic energy "
          << fKineticEnergy * 1.0e06 << " keV" << endl
          << "    ParentTrackID " << fParentTrackID << ", primaryParticleID " << fPrimaryParticleID << ", TrackStatus "
@@ -22,6 +22,7 @@
 #include "TVector3.h"
 
 #include "FairMCPoint.h"
+#include "R3BGTPCStringTable.h"
 
 class R3BGTPCPoint : public FairMCPoint
 {
@@ -90,9 +91,10 @@ class R3BGTPCPoint : public FairMCPoint
     Int_t GetPDGCode() const { return fPDGCode; }
     Int_t GetModuleID() const { return fModuleID; }
     Int_t GetDetCopyID() const { return fDetCopyID; }
-    TString GetParticleName() const { return fParticleName; }
-    TString GetVolName() const { return fVolName; }
-    TString GetProcessName() const { return fProcessName; }
+    // names stored in R3BGTPCStringTable (id >= 0) or in the point
+    TString GetParticleName() const { return ResolveName(fParticleNameId, fParticleName); }
+    TString GetVolName() const { return ResolveName(fVolNameId, fVolName); }
+    TString GetProcessName() const { return ResolveName(fProcessNameId, fProcessName); }
     Double_t GetCharge() const { return fCharge; }
     Double_t GetMass() const { return fMass; }
     Double_t GetKineticEnergy() const { return fKineticEnergy; }
@@ -106,9 +108,28 @@ class R3BGTPCPoint : public FairMCPoint
     void SetPDGCode(Int_t code) { fPDGCode = code; }
     void SetModuleID(Int_t id) { fModuleID = id; }
     void SetDetCopyID(Int_t id) { fDetCopyID = id; }
-    void SetParticleName(TString name) { fParticleName = name; }
-    void SetVolName(TString name) { fVolName = name; }
-    void SetProcessName(TString name) { fProcessName = name; }
+    void SetParticleName(TString name)
+    {
+        fParticleName = name;
+        fParticleNameId = -1;
+    }
+    void SetVolName(TString name)
+    {
+        fVolName = name;
+        fVolNameId = -1;
+    }
+    void SetProcessName(TString name)
+    {
+        fProcessName = name;
+        fProcessNameId = -1;
+    }
+    /** Names as ids of R3BGTPCStringTable, the strings of the point being left empty **/
+    void SetNameIds(Short_t particleNameId, Short_t volNameId, Short_t processNameId)
+    {
+        fParticleNameId = particleNameId;
+        fVolNameId = volNameId;
+        fProcessNameId = processNameId;
+    }
     void SetCharge(Double_t val) { fCharge = val; }
     void SetMass(Double_t val) { fMass = val; }
     void SetKineticEnergy(Double_t val) { fKineticEnergy = val; }
@@ -118,6 +139,12 @@ class R3BGTPCPoint : public FairMCPoint
     /** Output to screen **/
     virtual void Print(const Option_t* opt = "") const;
 
+  private:
+    static const TString& ResolveName(Short_t id, const TString& name)
+    {
+        return id < 0 ? name : R3BGTPCStringTable::Instance()->GetString(id);
+    }
+
   protected:
     Int_t fParentTrackID;     ///< Parent track ID
     Int_t fPrimaryParticleID; ///< Primary Particle ID
@@ -128,13 +155,16 @@ class R3BGTPCPoint : public FairMCPoint
     TString fParticleName;    ///< Name of the particle specified by pdg
     TString fVolName;         ///< Volume name for a given volume identifier id
     TString fProcessName;     ///< Process that has produced the secondary particles in the current step
+    Short_t fParticleNameId;  ///< Id of the particle name in R3BGTPCStringTable, -1 if in fParticleName
+    Short_t fVolNameId;       ///< Id of the volume name in R3BGTPCStringTable, -1 if in fVolName
+    Short_t fProcessNameId;   ///< Id of the process name in R3BGTPCStringTable, -1 if in fProcessName
     Double_t fCharge;         ///< Charge of the track currently transported
     Double_t fMass;           ///< Mass of the track currently transported
     Double_t fKineticEnergy;  ///< ???
     Double_t fTrackStep;      ///< Length in centimeters of the current step (in cm)???
     Bool_t fIsAccepted;       ///< ???
 
-    ClassDef(R3BGTPCPoint, 1)
+    ClassDef(R3BGTPCPoint, 2)
 };
 
 #endif
@@ -17,7 +17,6 @@ R3BGTPCProjPoint::R3BGTPCProjPoint()
 {
     fVirtualPadID = 0;
     fCharge = 0.;
-    fTimeDistr = NULL;
     fPDGCode = 0;
     fMotherId = 0;
     fx0 = 0;
@@ -43,10 +42,6 @@ R3BGTPCProjPoint::R3BGTPCProjPoint(Int_t pad,
 {
     fVirtualPadID = pad;
     fCharge = charge;
-    char hname[255];
-    sprintf(hname, "event %i: pad %i", eventID, fVirtualPadID);
-    fTimeDistr = new TH1S(hname, hname, 400, 0, 40); // this is for microsec
-    // fTimeDistr = new TH1S(hname, hname, 400000, 0, 40000);//this is for nanosec
     SetTimeDistr(time, charge);
     fPDGCode = PdgCode;
     fMotherId = MotherId;
@@ -58,16 +53,8 @@ R3BGTPCProjPoint::R3BGTPCProjPoint(Int_t pad,
     fpz0 = pz0;
 }
 
-R3BGTPCProjPoint::~R3BGTPCProjPoint()
-{
-    if (fTimeDistr)
-        delete fTimeDistr;
-}
+R3BGTPCProjPoint::~R3BGTPCProjPoint() {}
 
-void R3BGTPCProjPoint::Clear(Option_t* option)
-{
-    if (fTimeDistr)
-        delete fTimeDistr;
-}
+void R3BGTPCProjPoint::Clear(Option_t* option) { fTimeDistr.Reset(); }
 
 ClassImp(R3BGTPCProjPoint)
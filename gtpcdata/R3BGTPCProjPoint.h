@@ -19,7 +19,7 @@
 #ifndef R3BGTPCPROJPOINT_H
 #define R3BGTPCPROJPOINT_H
 
-#include "TH1S.h"
+#include "R3BGTPCTimeDistribution.h"
 #include "TObject.h"
 
 class R3BGTPCProjPoint : public TObject
@@ -48,8 +48,8 @@ class R3BGTPCProjPoint : public TObject
     /** Accessors **/
     Int_t GetVirtualPadID() const { return fVirtualPadID; }
     Double_t GetCharge() const { return fCharge; }
-    TH1S* GetTimeDistribution() const { return fTimeDistr; }
-    Int_t GetTimeDistribution(Int_t bin) { return fTimeDistr->GetBinContent(bin); }
+    const R3BGTPCTimeDistribution* GetTimeDistribution() const { return &fTimeDistr; }
+    Int_t GetTimeDistribution(Int_t bin) const { return fTimeDistr.GetBinContent(bin); }
     // Vertex
     Int_t GetPDGCode() const { return fPDGCode; }
     Int_t GetMotherId() const { return fMotherId; }
@@ -64,18 +64,18 @@ class R3BGTPCProjPoint : public TObject
     void SetVirtualPadID(Int_t pad) { fVirtualPadID = pad; }
     void SetCharge(Double_t cha) { fCharge = cha; }
     void AddCharge() { fCharge = fCharge + 1; }
-    void SetTimeDistr(Double_t time, Double_t weight) { fTimeDistr->Fill(time, weight); }
+    void SetTimeDistr(Double_t time, Double_t weight) { fTimeDistr.Fill(time, weight); }
 
     void Clear(Option_t* option);
 
   private:
-    Int_t fVirtualPadID; //!< Virtual pad Identifier
-    Double_t fCharge;    //!< Charge [electrons]
-    TH1S* fTimeDistr;    //!< Time distribution in the pad [0.1 microsecond/bin]
-                         // Vertex
+    Int_t fVirtualPadID;                //!< Virtual pad Identifier
+    Double_t fCharge;                   //!< Charge [electrons]
+    R3BGTPCTimeDistribution fTimeDistr; //!< Time distribution in the pad [0.1 microsecond/bin]
+                                        // Vertex
     Int_t fPDGCode, fMotherId;
     Double_t fx0, fy0, fz0, fpx0, fpy0, fpz0;
-    ClassDef(R3BGTPCProjPoint, 1)
+    ClassDef(R3BGTPCProjPoint, 2)
 };
 
 #endif // R3BGTPCPROJPOINT_H
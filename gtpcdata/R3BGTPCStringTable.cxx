@@ -0,0 +1,116 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCStringTable.h"
+
+#include "FairLogger.h"
+#include "FairRootManager.h"
+#include "FairRun.h"
+
+#include "TChain.h"
+#include "TFile.h"
+
+R3BGTPCStringTable::R3BGTPCStringTable()
+    : fLoaded(kFALSE)
+    , fUnknownReported(kFALSE)
+{
+}
+
+R3BGTPCStringTable* R3BGTPCStringTable::Instance()
+{
+    static R3BGTPCStringTable table;
+    return &table;
+}
+
+Bool_t R3BGTPCStringTable::Load(TFile* file)
+{
+    R3BGTPCStringTable* table = Instance();
+    R3BGTPCStringTable* stored = file ? (R3BGTPCStringTable*)file->Get(kKeyName) : nullptr;
+    if (!stored)
+        return kFALSE;
+    table->Clear();
+    table->fFileName = file->GetName();
+    table->fLoaded = kTRUE;
+    table->fStrings = stored->fStrings;
+    for (size_t id = 0; id < table->fStrings.size(); id++)
+        table->fIds[table->fStrings[id].Data()] = id;
+    delete stored;
+    return kTRUE;
+}
+
+Short_t R3BGTPCStringTable::GetId(const char* string)
+{
+    auto it = fIds.find(string);
+    if (it != fIds.end())
+        return it->second;
+    if (GetSize() >= kMaxSize)
+        return -1;
+    Short_t id = fStrings.size();
+    fStrings.push_back(string);
+    fIds[string] = id;
+    return id;
+}
+
+const TString& R3BGTPCStringTable::GetString(Int_t id)
+{
+    static const TString empty;
+    if (id < 0)
+        return empty;
+    // the ids of another file index another table
+    TFile* file = InputFile();
+    TString fileName = file ? file->GetName() : "";
+    if (fileName != fFileName)
+    {
+        // a table filled in this process stays valid until a file brings its own
+        if (!Load(file) && (fLoaded || GetSize() == 0))
+        {
+            Clear();
+            LOG(error) << "R3BGTPCStringTable: no " << kKeyName << " in "
+                       << (file ? file->GetName() : "(no file)") << ", the names of the points are unknown";
+        }
+        fFileName = fileName;
+    }
+    if (id >= GetSize())
+    {
+        if (!fUnknownReported)
+            LOG(error) << "R3BGTPCStringTable: unknown name id " << id << ", names returned empty";
+        fUnknownReported = kTRUE;
+        return empty;
+    }
+    return fStrings[id];
+}
+
+TFile* R3BGTPCStringTable::InputFile()
+{
+    // within a FairRun the current file is the output sink, not the input
+    if (FairRun::Instance())
+    {
+        FairRootManager* ioman = FairRootManager::Instance();
+        TChain* chain = ioman->GetInChain();
+        TFile* file = chain ? chain->GetFile() : ioman->GetInFile();
+        if (file)
+            return file;
+    }
+    return gFile;
+}
+
+void R3BGTPCStringTable::Clear(Option_t* /*option*/)
+{
+    fStrings.clear();
+    fIds.clear();
+    fFileName = "";
+    fLoaded = kFALSE;
+    fUnknownReported = kFALSE;
+}
+
+ClassImp(R3BGTPCStringTable)
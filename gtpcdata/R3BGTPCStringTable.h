@@ -0,0 +1,82 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCStringTable.h
+ **  Table of the particle, volume and process names of the R3BGTPCPoints,
+ **  the points keeping only the index of their names.
+ **/
+
+#ifndef R3BGTPCSTRINGTABLE_H
+#define R3BGTPCSTRINGTABLE_H
+
+#include "TObject.h"
+#include "TString.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TFile;
+
+/**
+ * GTPC string table
+ *
+ * Filled during the transport by R3BGTPC (see R3BGTPC::SetStringTable) and
+ * written once per run to the output file, under kKeyName. The ids are given
+ * in order of first use, so each file has its own table: when reading, the
+ * table follows the input file (the current file of the FairRootManager input
+ * chain within a FairRun, gFile otherwise) and is reloaded whenever it
+ * changes, or is loaded explicitly with Load. A table filled in this process
+ * is kept for the files without a table (the output file of the run).
+ */
+class R3BGTPCStringTable : public TObject
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCStringTable();
+
+    /** Destructor **/
+    virtual ~R3BGTPCStringTable() {}
+
+    /** Table used by R3BGTPCPoint **/
+    static R3BGTPCStringTable* Instance();
+
+    /** Replaces the table by the one stored in file; kFALSE if there is none **/
+    static Bool_t Load(TFile* file);
+
+    /** Id of a string, added to the table on first use; -1 if the table is full **/
+    Short_t GetId(const char* string);
+
+    /** String of an id, empty if unknown **/
+    const TString& GetString(Int_t id);
+
+    Int_t GetSize() const { return fStrings.size(); }
+
+    virtual void Clear(Option_t* option = "");
+
+    static constexpr const char* kKeyName = "GTPCStringTable"; //!< Key of the table in the files
+    static const Int_t kMaxSize = 32767;                       //!< Largest number of strings
+
+  private:
+    std::vector<TString> fStrings;                 // Strings, by id
+    std::unordered_map<std::string, Short_t> fIds; //! Id of each string, rebuilt after reading
+    TString fFileName;                             //! File the table belongs to
+    Bool_t fLoaded;                                //! Whether the table was loaded from fFileName
+    Bool_t fUnknownReported;                       //! Whether an unknown id was reported
+
+    /** File the names are resolved in **/
+    static TFile* InputFile();
+
+    ClassDef(R3BGTPCStringTable, 1)
+};
+
+#endif // R3BGTPCSTRINGTABLE_H
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+
+#include "R3BGTPCTimeDistribution.h"
+
+#include "TH1S.h"
+
+#include <cmath>
+
+R3BGTPCTimeDistribution::R3BGTPCTimeDistribution()
+    : fNumInline(0)
+    , fEntries(0)
+    , fSumW(0)
+    , fSumW2(0)
+    , fSumWX(0)
+    , fSumWX2(0)
+{
+}
+
+void R3BGTPCTimeDistribution::Fill(Double_t time, Double_t weight)
+{
+    Short_t bin;
+    if (time < kTimeMin)
+        bin = 0;
+    else if (time >= kTimeMax)
+        bin = kNumBins + 1;
+    else
+    {
+        bin = 1 + (Short_t)std::floor((time - kTimeMin) / (kTimeMax - kTimeMin) * kNumBins);
+        fSumW += weight;
+        fSumW2 += weight * weight;
+        fSumWX += weight * time;
+        fSumWX2 += weight * time * time;
+    }
+    fEntries++;
+    AddToBin(bin, weight);
+}
+
+void R3BGTPCTimeDistribution::AddToBin(Short_t bin, Double_t weight)
+{
+    for (Int_t i = 0; i < fNumInline; i++)
+        if (fInlineBin[i] == bin)
+        {
+            fInlineContent[i] += weight;
+            return;
+        }
+    if (fNumInline < kInlineBins)
+    {
+        fInlineBin[fNumInline] = bin;
+        fInlineContent[fNumInline] = weight;
+        fNumInline++;
+        return;
+    }
+    fMoreBins[bin] += weight;
+}
+
+Double_t R3BGTPCTimeDistribution::GetBinContent(Int_t bin) const
+{
+    for (Int_t i = 0; i < fNumInline; i++)
+        if (fInlineBin[i] == bin)
+            return fInlineContent[i];
+    auto it = fMoreBins.find(bin);
+    return it == fMoreBins.end() ? 0. : it->second;
+}
+
+TH1S* R3BGTPCTimeDistribution::ToHistogram(const char* name) const
+{
+    TH1S* histo = new TH1S(name, name, kNumBins, kTimeMin, kTimeMax);
+    for (Int_t i = 0; i < fNumInline; i++)
+        histo->SetBinContent(fInlineBin[i], fInlineContent[i]);
+    for (const auto& bin : fMoreBins)
+        histo->SetBinContent(bin.first, bin.second);
+    // statistics of the filled times, as if the histogram had been filled
+    Double_t stats[4] = { fSumW, fSumW2, fSumWX, fSumWX2 };
+    histo->PutStats(stats);
+    histo->SetEntries(fEntries);
+    return histo;
+}
+
+void R3BGTPCTimeDistribution::FromHistogram(const TH1S& histo)
+{
+    Reset();
+    for (Int_t bin = 0; bin <= kNumBins + 1; bin++)
+    {
+        Double_t content = histo.GetBinContent(bin);
+        if (content != 0.)
+            AddToBin(bin, content);
+    }
+    Double_t stats[4];
+    histo.GetStats(stats);
+    fSumW = stats[0];
+    fSumW2 = stats[1];
+    fSumWX = stats[2];
+    fSumWX2 = stats[3];
+    fEntries = (Int_t)histo.GetEntries();
+}
+
+void R3BGTPCTimeDistribution::Reset()
+{
+    fNumInline = 0;
+    fMoreBins.clear();
+    fEntries = 0;
+    fSumW = 0;
+    fSumW2 = 0;
+    fSumWX = 0;
+    fSumWX2 = 0;
+}
+
+ClassImp(R3BGTPCTimeDistribution)
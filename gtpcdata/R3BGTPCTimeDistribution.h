@@ -0,0 +1,83 @@
+/******************************************************************************
+ *   Copyright (C) 2020 GSI Helmholtzzentrum für Schwerionenforschung GmbH    *
+ *   Copyright (C) 2020 Members of R3B Collaboration                          *
+ *                                                                            *
+ *             This software is distributed under the terms of the            *
+ *                 GNU General Public Licence (GPL) version 3,                *
+ *                    copied verbatim in the file "LICENSE".                  *
+ *                                                                            *
+ * In applying this license GSI does not waive the privileges and immunities  *
+ * granted to it by virtue of its status as an Intergovernmental Organization *
+ * or submit itself to any jurisdiction.                                      *
+ ******************************************************************************/
+/**  R3BGTPCTimeDistribution.h
+ **  Arrival time distribution of the electrons in a pad, with the binning of
+ **  the former TH1S of R3BGTPCProjPoint (400 bins of 0.1 from 0 to 40).
+ **/
+
+#ifndef R3BGTPCTIMEDISTRIBUTION_H
+#define R3BGTPCTIMEDISTRIBUTION_H
+
+#include "Rtypes.h"
+
+#include <map>
+
+class TH1S;
+
+/**
+ * GTPC pad time distribution
+ *
+ * Most pads collect a few electrons in a few bins: the first kInlineBins
+ * filled bins are kept in fixed arrays inside the object, the following ones
+ * in a sparse map. Bins are numbered as in TH1 (0 underflow, 1 to kNumBins,
+ * kNumBins + 1 overflow) and GetMean, like TH1::GetMean, is the weighted mean
+ * of the times filled inside the range. ToHistogram gives the equivalent TH1S
+ * for the macros working with histograms, FromHistogram the reverse (version 1
+ * of R3BGTPCProjPoint, see R3BGTPCDataLinkDef.h).
+ */
+class R3BGTPCTimeDistribution
+{
+  public:
+    /** Default constructor **/
+    R3BGTPCTimeDistribution();
+
+    /** Adds weight at time **/
+    void Fill(Double_t time, Double_t weight = 1.);
+
+    /** Content of a bin (TH1 numbering) **/
+    Double_t GetBinContent(Int_t bin) const;
+    /** Weighted mean of the times inside the range, 0 if none **/
+    Double_t GetMean() const { return fSumW > 0 ? fSumWX / fSumW : 0.; }
+    /** Number of Fill calls **/
+    Int_t GetEntries() const { return fEntries; }
+
+    /** New histogram with the same content and statistics, owned by the caller **/
+    TH1S* ToHistogram(const char* name) const;
+
+    /** Replaces the content and statistics by the ones of a histogram with the same binning **/
+    void FromHistogram(const TH1S& histo);
+
+    void Reset();
+
+    static const Int_t kNumBins = 400;        //!< Bins between kTimeMin and kTimeMax
+    static constexpr Double_t kTimeMin = 0.;  //!< Lower edge of the first bin
+    static constexpr Double_t kTimeMax = 40.; //!< Upper edge of the last bin
+    static const Int_t kInlineBins = 8;       //!< Filled bins stored without allocation
+
+  private:
+    void AddToBin(Short_t bin, Double_t weight);
+
+    Int_t fNumInline;                     // Filled bins in the arrays
+    Short_t fInlineBin[kInlineBins];      // Their bin numbers
+    Float_t fInlineContent[kInlineBins];  // Their contents
+    std::map<Short_t, Float_t> fMoreBins; // Filled bins beyond the arrays
+    Int_t fEntries;                       // Fill calls
+    Double_t fSumW;                       // Sums inside the range: weight,
+    Double_t fSumW2;                      // weight^2,
+    Double_t fSumWX;                      // weight * time
+    Double_t fSumWX2;                     // and weight * time^2
+
+    ClassDefNV(R3BGTPCTimeDistribution, 1)
+};
+
+#endif // R3BGTPCTIMEDISTRIBUTION_H
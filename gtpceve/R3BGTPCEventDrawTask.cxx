@@ -34,7 +34,8 @@ ClassImp(R3BGTPCEventDrawTask);
 R3BGTPCEventDrawTask::R3BGTPCEventDrawTask()
     : fCvsPadPlane(0)
     , fPadPlane(0)
-    , fMap(0)
+    , fMap(nullptr)
+    , fDetectorType(1)
     , fHitSet(0)
     , fCvsPadWave(0)
     , fPadWave(0)
@@ -54,7 +55,7 @@ InitStatus R3BGTPCEventDrawTask::Init()
     FairRootManager* ioMan = FairRootManager::Instance();
     fEventManager = R3BGTPCEventManager::Instance();
 
-    fMap = new R3BGTPCMap();
+    fMap = R3BGTPCMapRegistry::Get(fDetectorType);
 
     // Data
     fHitCA = (TClonesArray*)ioMan->GetObject("GTPCHitData");
@@ -246,8 +247,9 @@ void R3BGTPCEventDrawTask::DrawPadPlane()
         return;
     }
 
-    fMap->GeneratePadPlane();
-    fPadPlane = fMap->GetPadPlane();
+    // the shared pad plane is not modified, the hits are filled in a clone
+    fPadPlane = (TH2Poly*)fMap->GetPadPlane()->Clone("R3BGTPC_Plane_Display");
+    fPadPlane->ChangePartition(500, 500);
     fCvsPadPlane->cd();
     // fPadPlane -> Draw("COLZ L0"); //0  == bin lines adre not drawn
     fPadPlane->Draw("COL L");
@@ -5,7 +5,7 @@ class R3BGTPCEventManager;
 
 // GLAD-TPC classes
 #include "R3BGTPCHitData.h"
-#include "R3BGTPCMap.h"
+#include "R3BGTPCMapRegistry.h"
 #include "R3BGTPCTrackData.h"
 
 // FairRoot classes
@@ -45,13 +45,17 @@ class R3BGTPCEventDrawTask : public FairTask
     void Exec(Option_t* option);
     void Reset();
 
+    /** Detector type of the pad plane (1 Prototype, default, 2 FullBeamIn, 3 FullBeamOut) **/
+    void SetDetectorType(Int_t type) { fDetectorType = type; }
+
   private:
     R3BGTPCEventManager* fEventManager;
-    R3BGTPCMap* fMap;
+    std::shared_ptr<const R3BGTPCMap> fMap; // shared (R3BGTPCMapRegistry)
+    Int_t fDetectorType;
 
     // Canvases and histograms
     TCanvas* fCvsPadPlane;
-    TH2Poly* fPadPlane;
+    TH2Poly* fPadPlane; // clone of the map pad plane, filled in each event
     TCanvas* fCvsPadWave;
     TH1I* fPadWave;
 
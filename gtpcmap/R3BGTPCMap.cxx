@@ -1,11 +1,37 @@
 #include "R3BGTPCMap.h"
 
+#include "TList.h"
+#include "TXMLAttr.h"
+#include "TXMLDocument.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // Numeric attribute of an XML element, kFALSE if it is missing
+    Bool_t GetAttribute(TXMLNode* node, const char* key, Double_t& value)
+    {
+        TList* attributes = node->GetAttributes();
+        TXMLAttr* attribute = attributes ? (TXMLAttr*)attributes->FindObject(key) : nullptr;
+        if (!attribute)
+            return kFALSE;
+        value = std::atof(attribute->GetValue());
+        return kTRUE;
+    }
+} // namespace
+
 R3BGTPCMap::R3BGTPCMap()
-    : fPadCoord(boost::extents[5632][4][2])
+    : fRegions(1, PadRegion{ 0., 0., 2.0, 2.0, 128, 44, 0 }) // prototype: 128 x 44 pads of 2 mm
+    , fBucketZ0(0)
+    , fBucketX0(0)
+    , fBucketSizeZ(1)
+    , fBucketSizeX(1)
+    , fNumBucketsZ(0)
+    , fNumBucketsX(0)
+    , fPadCoord(boost::extents[0][4][2])
 {
 
-    fPadCoord.resize(boost::extents[5632][4][2]);
-    std::fill(fPadCoord.data(), fPadCoord.data() + fPadCoord.num_elements(), 0);
     fPadPlane = new TH2Poly();
 
     std::cout << " GLADTPC Map initialized " << std::endl;
@@ -14,33 +40,132 @@ R3BGTPCMap::R3BGTPCMap()
 
 R3BGTPCMap::~R3BGTPCMap() {}
 
-void R3BGTPCMap::GeneratePadPlane()
+Bool_t R3BGTPCMap::LoadPadPlane(const char* fileName)
 {
+    // <PadPlane>
+    //   <Region z0="0" x0="0" padSizeZ="2" padSizeX="2" cols="128" rows="44"/>  (lower corner and sides in mm)
+    //   <Pad z0="" x0="" z1="" x1="" z2="" x2="" z3="" x3=""/>                   (corners in mm, in order)
+    // </PadPlane>
+    // The regions are numbered first, in the order of the file, then the irregular pads
+    TDOMParser parser;
+    parser.SetValidate(kFALSE);
+    Int_t status = parser.ParseFile(fileName);
+    if (status != 0)
+    {
+        std::cout << " R3BGTPCMap::LoadPadPlane Error : cannot parse " << fileName << ": "
+                  << parser.GetParseCodeMessage(status) << std::endl;
+        return kFALSE;
+    }
+    TXMLNode* root = parser.GetXMLDocument()->GetRootNode();
+    if (!root || std::strcmp(root->GetNodeName(), "PadPlane") != 0)
+    {
+        std::cout << " R3BGTPCMap::LoadPadPlane Error : no PadPlane element in " << fileName << std::endl;
+        return kFALSE;
+    }
 
-    Float_t pad_size = 2.0;      // mm
-    Float_t pad_spacing = 0.001; // mm
+    const char* cornerKeys[8] = { "z0", "x0", "z1", "x1", "z2", "x2", "z3", "x3" };
+    std::vector<PadRegion> regions;
+    std::vector<std::array<Double_t, 8>> irregular;
+    Int_t numPads = 0;
+    for (TXMLNode* node = root->GetChildren(); node; node = node->GetNextNode())
+    {
+        if (node->GetNodeType() != TXMLNode::kXMLElementNode)
+            continue;
+        if (std::strcmp(node->GetNodeName(), "Region") == 0)
+        {
+            Double_t z0 = 0, x0 = 0, sizeZ = 0, sizeX = 0, cols = 0, rows = 0;
+            GetAttribute(node, "z0", z0);
+            GetAttribute(node, "x0", x0);
+            if (!GetAttribute(node, "padSizeZ", sizeZ) || !GetAttribute(node, "padSizeX", sizeX) ||
+                !GetAttribute(node, "cols", cols) || !GetAttribute(node, "rows", rows) || sizeZ <= 0 ||
+                sizeX <= 0 || cols < 1 || rows < 1)
+            {
+                std::cout << " R3BGTPCMap::LoadPadPlane Error : invalid Region in " << fileName << std::endl;
+                return kFALSE;
+            }
+            regions.push_back({ z0, x0, sizeZ, sizeX, (Int_t)cols, (Int_t)rows, numPads });
+            numPads += (Int_t)cols * (Int_t)rows;
+        }
+        else if (std::strcmp(node->GetNodeName(), "Pad") == 0)
+        {
+            std::array<Double_t, 8> corners;
+            for (Int_t k = 0; k < 8; k++)
+                if (!GetAttribute(node, cornerKeys[k], corners[k]))
+                {
+                    std::cout << " R3BGTPCMap::LoadPadPlane Error : Pad without " << cornerKeys[k] << " in "
+                              << fileName << std::endl;
+                    return kFALSE;
+                }
+            irregular.push_back(corners);
+        }
+    }
+    numPads += irregular.size();
+    if (numPads == 0)
+    {
+        std::cout << " R3BGTPCMap::LoadPadPlane Error : no pads in " << fileName << std::endl;
+        return kFALSE;
+    }
+    if (numPads > 65536)
+        std::cout << " R3BGTPCMap::LoadPadPlane Warning : " << numPads
+                  << " pads, more than the 16 bit pad numbers of the data" << std::endl;
+
+    fRegions = regions;
+    fIrregular = irregular;
+    std::cout << " R3BGTPCMap: " << numPads << " pads in " << fRegions.size() << " regions and " << fIrregular.size()
+              << " irregular pads, from " << fileName << std::endl;
+    return kTRUE;
+}
 
-    Float_t ZOffset = 0.0; // 272.7;
-    Float_t XOffset = 0.0; // 5.8;
+void R3BGTPCMap::GeneratePadPlane()
+{
 
-    Int_t padCnt = 0;
+    Int_t numRegular = 0;
+    for (const auto& region : fRegions)
+        numRegular += region.numCols * region.numRows;
+    Int_t numPads = numRegular + fIrregular.size();
+    fPadCoord.resize(boost::extents[numPads][4][2]);
+    fPadInfo.resize(numPads);
 
     // x - y (Z - X in GLAD convention)
-    for (auto icol = 0; icol < 128; ++icol)
-        for (auto irow = 0; irow < 44; ++irow)
+    for (const auto& region : fRegions)
+        for (auto icol = 0; icol < region.numCols; ++icol)
+            for (auto irow = 0; irow < region.numRows; ++irow)
+            {
+                Int_t padCnt = region.firstPad + icol * region.numRows + irow;
+                Double_t z = region.z0 + region.sizeZ * icol;
+                Double_t x = region.x0 + region.sizeX * irow;
+                fPadCoord[padCnt][0][0] = z;
+                fPadCoord[padCnt][0][1] = x;
+                fPadCoord[padCnt][1][0] = z;
+                fPadCoord[padCnt][1][1] = x + region.sizeX;
+                fPadCoord[padCnt][2][0] = z + region.sizeZ;
+                fPadCoord[padCnt][2][1] = x + region.sizeX;
+                fPadCoord[padCnt][3][0] = z + region.sizeZ;
+                fPadCoord[padCnt][3][1] = x;
+
+                // flat table of the pad centers for the lookups
+                fPadInfo[padCnt].z = z + region.sizeZ / 2.0;
+                fPadInfo[padCnt].x = x + region.sizeX / 2.0;
+                fPadInfo[padCnt].col = icol;
+                fPadInfo[padCnt].row = irow;
+            }
+
+    for (size_t i = 0; i < fIrregular.size(); ++i)
+    {
+        Int_t padCnt = numRegular + i;
+        fPadInfo[padCnt].z = fPadInfo[padCnt].x = 0;
+        for (auto icorner = 0; icorner < 4; ++icorner)
         {
-            fPadCoord[padCnt][0][0] = pad_size * (Float_t)icol + ZOffset;
-            fPadCoord[padCnt][0][1] = pad_size * (Float_t)irow + XOffset;
-            fPadCoord[padCnt][1][0] = pad_size * (Float_t)icol + ZOffset;
-            fPadCoord[padCnt][1][1] = pad_size * (Float_t)irow + pad_size + XOffset;
-            fPadCoord[padCnt][2][0] = pad_size * (Float_t)icol + pad_size + ZOffset;
-            fPadCoord[padCnt][2][1] = pad_size * (Float_t)irow + pad_size + XOffset;
-            fPadCoord[padCnt][3][0] = pad_size * (Float_t)icol + pad_size + ZOffset;
-            fPadCoord[padCnt][3][1] = pad_size * (Float_t)irow + XOffset;
-            ++padCnt;
+            fPadCoord[padCnt][icorner][0] = fIrregular[i][2 * icorner];
+            fPadCoord[padCnt][icorner][1] = fIrregular[i][2 * icorner + 1];
+            fPadInfo[padCnt].z += fIrregular[i][2 * icorner] / 4.0;
+            fPadInfo[padCnt].x += fIrregular[i][2 * icorner + 1] / 4.0;
         }
+        fPadInfo[padCnt].col = -1;
+        fPadInfo[padCnt].row = -1;
+    }
 
-    for (auto ipad = 0; ipad < 5632; ++ipad)
+    for (auto ipad = 0; ipad < numPads; ++ipad)
     {
         Double_t px[] = { fPadCoord[ipad][0][0],
                           fPadCoord[ipad][1][0],
@@ -54,42 +179,145 @@ void R3BGTPCMap::GeneratePadPlane()
                           fPadCoord[ipad][0][1] };
         Int_t bin = fPadPlane->AddBin(5, px, py);
     }
+
+    fPadPlane->SetName("R3BGTPC_Plane");
+    fPadPlane->SetTitle("R3BGTPC_Plane");
+    fPadPlane->ChangePartition(500, 500);
+
+    BuildBucketGrid(numRegular);
 }
 
-std::vector<Float_t> R3BGTPCMap::CalcPadCenter(Int_t PadRef)
+void R3BGTPCMap::BuildBucketGrid(Int_t firstIrregularPad)
 {
+    fBucketStart.clear();
+    fBucketPads.clear();
+    Int_t numPads = GetNumPads();
+    if (firstIrregularPad >= numPads)
+        return;
 
-    std::vector<Float_t> PadCenter = { -9999, -9999 };
-    PadCenter.reserve(2);
-
-    if (fPadPlane == 0)
+    // bounding boxes of the irregular pads; buckets of about the mean pad size, so
+    // that a bucket overlaps a few pads whatever the number of pads
+    std::vector<std::array<Double_t, 4>> boxes; // zmin, zmax, xmin, xmax
+    Double_t zmin = 1e30, zmax = -1e30, xmin = 1e30, xmax = -1e30, sumZ = 0, sumX = 0;
+    for (auto ipad = firstIrregularPad; ipad < numPads; ++ipad)
     {
+        std::array<Double_t, 4> box = { 1e30, -1e30, 1e30, -1e30 };
+        for (auto icorner = 0; icorner < 4; ++icorner)
+        {
+            box[0] = std::min(box[0], fPadCoord[ipad][icorner][0]);
+            box[1] = std::max(box[1], fPadCoord[ipad][icorner][0]);
+            box[2] = std::min(box[2], fPadCoord[ipad][icorner][1]);
+            box[3] = std::max(box[3], fPadCoord[ipad][icorner][1]);
+        }
+        zmin = std::min(zmin, box[0]);
+        zmax = std::max(zmax, box[1]);
+        xmin = std::min(xmin, box[2]);
+        xmax = std::max(xmax, box[3]);
+        sumZ += box[1] - box[0];
+        sumX += box[3] - box[2];
+        boxes.push_back(box);
+    }
+    const Int_t kMaxBuckets = 1024; // per axis
+    fBucketZ0 = zmin;
+    fBucketX0 = xmin;
+    fNumBucketsZ = std::min(kMaxBuckets, std::max(1, (Int_t)std::ceil((zmax - zmin) / (sumZ / boxes.size()))));
+    fNumBucketsX = std::min(kMaxBuckets, std::max(1, (Int_t)std::ceil((xmax - xmin) / (sumX / boxes.size()))));
+    fBucketSizeZ = std::max((zmax - zmin) / fNumBucketsZ, 1e-6);
+    fBucketSizeX = std::max((xmax - xmin) / fNumBucketsX, 1e-6);
 
-        //std::cout << " R3BGTPCMap::CalcPadCenter Error : Pad plane not found" << std::endl;
-        return PadCenter;
+    // two passes: bucket sizes, then the pads of each bucket in a single array
+    auto bucketRange = [this](const std::array<Double_t, 4>& box, Int_t* range)
+    {
+        range[0] = std::min(fNumBucketsZ - 1, (Int_t)((box[0] - fBucketZ0) / fBucketSizeZ));
+        range[1] = std::min(fNumBucketsZ - 1, (Int_t)((box[1] - fBucketZ0) / fBucketSizeZ));
+        range[2] = std::min(fNumBucketsX - 1, (Int_t)((box[2] - fBucketX0) / fBucketSizeX));
+        range[3] = std::min(fNumBucketsX - 1, (Int_t)((box[3] - fBucketX0) / fBucketSizeX));
+    };
+    fBucketStart.assign(fNumBucketsZ * fNumBucketsX + 1, 0);
+    Int_t range[4];
+    for (const auto& box : boxes)
+    {
+        bucketRange(box, range);
+        for (auto iz = range[0]; iz <= range[1]; ++iz)
+            for (auto ix = range[2]; ix <= range[3]; ++ix)
+                fBucketStart[iz * fNumBucketsX + ix + 1]++;
     }
+    for (size_t b = 1; b < fBucketStart.size(); ++b)
+        fBucketStart[b] += fBucketStart[b - 1];
+    fBucketPads.resize(fBucketStart.back());
+    std::vector<Int_t> next(fBucketStart.begin(), fBucketStart.end() - 1);
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        bucketRange(boxes[i], range);
+        for (auto iz = range[0]; iz <= range[1]; ++iz)
+            for (auto ix = range[2]; ix <= range[3]; ++ix)
+                fBucketPads[next[iz * fNumBucketsX + ix]++] = firstIrregularPad + i;
+    }
+}
 
-    if (PadRef >= 0 && PadRef < fPadCoord.shape()[0])
-    { // Boost multi_array crashes with a negative index
+Int_t R3BGTPCMap::IrregularPadId(Double_t z, Double_t x) const
+{
+    Double_t bz = (z - fBucketZ0) / fBucketSizeZ;
+    Double_t bx = (x - fBucketX0) / fBucketSizeX;
+    if (!(bz >= 0. && bz <= fNumBucketsZ && bx >= 0. && bx <= fNumBucketsX))
+        return -1;
+    Int_t bucket = std::min((Int_t)bz, fNumBucketsZ - 1) * fNumBucketsX + std::min((Int_t)bx, fNumBucketsX - 1);
+    for (auto k = fBucketStart[bucket]; k < fBucketStart[bucket + 1]; ++k)
+        if (IsInsidePad(fBucketPads[k], z, x))
+            return fBucketPads[k];
+    return -1;
+}
 
-        Float_t x = (fPadCoord[PadRef][0][0] + fPadCoord[PadRef][3][0]) / 2.0;
-        PadCenter[0] = x;
-        Float_t y = (fPadCoord[PadRef][0][1] + fPadCoord[PadRef][1][1]) / 2.0;
-        PadCenter[1] = y;
-        return PadCenter;
+Bool_t R3BGTPCMap::IsInsidePad(Int_t pad, Double_t z, Double_t x) const
+{
+    // same side of the four edges (boundary included)
+    Bool_t positive = kFALSE, negative = kFALSE;
+    for (auto icorner = 0; icorner < 4; ++icorner)
+    {
+        Int_t inext = (icorner + 1) % 4;
+        Double_t cross = (fPadCoord[pad][inext][0] - fPadCoord[pad][icorner][0]) * (x - fPadCoord[pad][icorner][1]) -
+                         (fPadCoord[pad][inext][1] - fPadCoord[pad][icorner][1]) * (z - fPadCoord[pad][icorner][0]);
+        positive |= cross > 0;
+        negative |= cross < 0;
     }
-    else
+    return !(positive && negative);
+}
+
+std::vector<Float_t> R3BGTPCMap::CalcPadCenter(Int_t PadRef) const
+{
+    Double_t z, x;
+    if (!GetPadCenter(PadRef, z, x) && !fPadInfo.empty())
     {
-        std::cout << PadRef<<" ; " <<fPadCoord.shape()[0]<< '\n';
+        std::cout << PadRef << " ; " << fPadInfo.size() << '\n';
         std::cout << " R3BGTPCMap::CalcPadCenter Error : Pad not found" << std::endl;
-        return PadCenter;
     }
+    return { (Float_t)z, (Float_t)x };
+}
+
+void R3BGTPCMap::GetPadCenters(const Int_t* pads, Int_t n, Double_t* z, Double_t* x) const
+{
+    for (Int_t i = 0; i < n; i++)
+        GetPadCenter(pads[i], z[i], x[i]);
+}
+
+void R3BGTPCMap::GetPadCenters(const std::vector<Int_t>& pads,
+                               std::vector<Double_t>& z,
+                               std::vector<Double_t>& x) const
+{
+    z.resize(pads.size());
+    x.resize(pads.size());
+    GetPadCenters(pads.data(), pads.size(), z.data(), x.data());
 }
 
 TH2Poly* R3BGTPCMap::GetPadPlane()
+{
+    return const_cast<TH2Poly*>(static_cast<const R3BGTPCMap*>(this)->GetPadPlane());
+}
+
+const TH2Poly* R3BGTPCMap::GetPadPlane() const
 {
 
-    if (fPadPlane == 0)
+    if (fPadInfo.empty())
     {
 
         std::cout << " R3BGTPCMap::GetAtTPCPlane Error : Pad plane has not been generated - Exiting... " << std::endl;
@@ -97,10 +325,6 @@ TH2Poly* R3BGTPCMap::GetPadPlane()
         return NULL;
     }
 
-    fPadPlane->SetName("R3BGTPC_Plane");
-    fPadPlane->SetTitle("R3BGTPC_Plane");
-    fPadPlane->ChangePartition(500, 500);
-
     return fPadPlane;
 }
 
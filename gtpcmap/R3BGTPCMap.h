@@ -12,7 +12,10 @@
 #include "TROOT.h"
 #include "TStyle.h"
 #include "TXMLNode.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -29,18 +32,104 @@ class R3BGTPCMap : public TObject
     typedef boost::multi_array<double, 3> multiarray;
     typedef multiarray::index index;
 
+    /** Pad layout from an XML file (see params/GTPCPadPlane_*.xml), to be called before GeneratePadPlane.
+     * kFALSE, keeping the current layout, if the file cannot be read. Without it the layout is the
+     * prototype one, 128 x 44 pads of 2 mm **/
+    Bool_t LoadPadPlane(const char* fileName);
+
     void GeneratePadPlane();
     Int_t BinToPad(Int_t binval);
-    std::vector<Float_t> CalcPadCenter(Int_t PadRef);
+    std::vector<Float_t> CalcPadCenter(Int_t PadRef) const;
     TH2Poly* GetPadPlane();
+    const TH2Poly* GetPadPlane() const;
+    Int_t GetNumPads() const { return fPadCoord.shape()[0]; }
+
+    /** Pad containing the point (z, x) [mm] of the pad plane, -1 outside of it. Computed from
+     * the regular pad regions (the upper and right edges belong to the pad), then from the
+     * bucket grid of the irregular pads, without touching the histogram **/
+    inline Int_t PadIdFromPosition(Double_t z, Double_t x) const
+    {
+        for (const auto& region : fRegions)
+        {
+            // clamping keeps the conversion to integer defined far from the plane
+            Int_t col = (Int_t)std::ceil(
+                            std::min(std::max((z - region.z0) / region.sizeZ, -1.), (Double_t)region.numCols + 1.)) -
+                        1;
+            Int_t row = (Int_t)std::ceil(
+                            std::min(std::max((x - region.x0) / region.sizeX, -1.), (Double_t)region.numRows + 1.)) -
+                        1;
+            if (((UInt_t)col < (UInt_t)region.numCols) & ((UInt_t)row < (UInt_t)region.numRows))
+                return region.firstPad + col * region.numRows + row;
+        }
+        return fBucketPads.empty() ? -1 : IrregularPadId(z, x);
+    }
+
+    /** Center (z, x) [mm] of a pad, from the table filled by GeneratePadPlane. No allocation, for the
+     * loops over pads and time buckets. kFALSE (and -9999) for an unknown pad **/
+    inline Bool_t GetPadCenter(Int_t pad, Double_t& z, Double_t& x) const
+    {
+        if ((UInt_t)pad >= (UInt_t)fPadInfo.size())
+        {
+            z = x = -9999;
+            return kFALSE;
+        }
+        z = fPadInfo[pad].z;
+        x = fPadInfo[pad].x;
+        return kTRUE;
+    }
+    /** Column (along Z) and row (along X) of a pad in its region, -1 for an unknown or irregular pad **/
+    inline Int_t GetPadColumn(Int_t pad) const
+    {
+        return (UInt_t)pad < (UInt_t)fPadInfo.size() ? fPadInfo[pad].col : -1;
+    }
+    inline Int_t GetPadRow(Int_t pad) const
+    {
+        return (UInt_t)pad < (UInt_t)fPadInfo.size() ? fPadInfo[pad].row : -1;
+    }
+
+    /** Centers z[i], x[i] [mm] of the n pads pads[i] (-9999 for unknown pads) **/
+    void GetPadCenters(const Int_t* pads, Int_t n, Double_t* z, Double_t* x) const;
+    void GetPadCenters(const std::vector<Int_t>& pads, std::vector<Double_t>& z, std::vector<Double_t>& x) const;
 
   private:
+    // Regular block of pads, numbered firstPad + col * numRows + row
+    struct PadRegion
+    {
+        Double_t z0, x0;       // lower corner [mm]
+        Double_t sizeZ, sizeX; // pad sides [mm]
+        Int_t numCols;         // pad columns along Z
+        Int_t numRows;         // pad rows along X
+        Int_t firstPad;
+    };
+
+    // Geometry of a pad, 16 bytes so that four pads share a cache line
+    struct alignas(16) PadInfo
+    {
+        Float_t z, x;   // center [mm]
+        Int_t col, row; // column along Z, row along X
+    };
+
+    /** Pad of the irregular pads containing (z, x) [mm], -1 if none **/
+    Int_t IrregularPadId(Double_t z, Double_t x) const;
+    /** Whether (z, x) [mm] is inside the (convex) quadrilateral of a pad **/
+    Bool_t IsInsidePad(Int_t pad, Double_t z, Double_t x) const;
+    /** Buckets of the irregular pads, filled by GeneratePadPlane **/
+    void BuildBucketGrid(Int_t firstIrregularPad);
+
+    std::vector<PadRegion> fRegions;                 //!< Regular pad regions
+    std::vector<std::array<Double_t, 8>> fIrregular; //!< Corners (z0, x0, ..., z3, x3) [mm] of the irregular pads
+    Double_t fBucketZ0, fBucketX0;                   //!< Lower corner of the bucket grid [mm]
+    Double_t fBucketSizeZ, fBucketSizeX;             //!< Bucket sides [mm]
+    Int_t fNumBucketsZ, fNumBucketsX;                //!< Buckets along Z and X
+    std::vector<Int_t> fBucketStart;                 //!< First entry of each bucket in fBucketPads
+    std::vector<Int_t> fBucketPads;                  //!< Irregular pads overlapping each bucket
     multiarray fPadCoord;
+    std::vector<PadInfo> fPadInfo; //!< Pad centers, columns and rows, filled by GeneratePadPlane
     multiarray* fPadCoordPtr;
     std::map<std::vector<int>, int> fPadMap;
     TH2Poly* fPadPlane;
 
-    ClassDefOverride(R3BGTPCMap, 1);
+    ClassDefOverride(R3BGTPCMap, 2);
 };
 
 #endif
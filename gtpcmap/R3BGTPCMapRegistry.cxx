@@ -0,0 +1,53 @@
+#include "R3BGTPCMapRegistry.h"
+
+#include "TSystem.h"
+
+std::mutex& R3BGTPCMapRegistry::GetMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<Int_t, TString>& R3BGTPCMapRegistry::GetLayoutFiles()
+{
+    static std::map<Int_t, TString> layoutFiles;
+    return layoutFiles;
+}
+
+void R3BGTPCMapRegistry::SetLayoutFile(Int_t detectorType, const char* fileName)
+{
+    std::lock_guard<std::mutex> lock(GetMutex());
+    GetLayoutFiles()[detectorType] = fileName;
+}
+
+std::shared_ptr<const R3BGTPCMap> R3BGTPCMapRegistry::Get(Int_t detectorType)
+{
+    static std::map<Int_t, std::shared_ptr<const R3BGTPCMap>> maps;
+
+    std::lock_guard<std::mutex> lock(GetMutex());
+    auto& map = maps[detectorType];
+    if (!map)
+    {
+        auto newMap = std::make_shared<R3BGTPCMap>();
+
+        TString fileName;
+        auto layoutFile = GetLayoutFiles().find(detectorType);
+        if (layoutFile != GetLayoutFiles().end())
+            fileName = layoutFile->second;
+        else
+        {
+            const char* names[] = { "Prototype", "FullBeamIn", "FullBeamOut" };
+            const char* workDir = gSystem->Getenv("VMCWORKDIR");
+            if (detectorType >= 1 && detectorType <= 3 && workDir)
+                fileName = TString(workDir) + "/glad-tpc/params/GTPCPadPlane_" + names[detectorType - 1] + ".xml";
+        }
+        if (fileName.IsNull() || !newMap->LoadPadPlane(fileName))
+            std::cout << " R3BGTPCMapRegistry Warning : no pad layout for detector type " << detectorType
+                      << ", using the prototype pad plane" << std::endl;
+
+        newMap->GeneratePadPlane();
+        map = newMap;
+        std::cout << " R3BGTPCMapRegistry: pad plane generated for detector type " << detectorType << std::endl;
+    }
+    return map;
+}
@@ -0,0 +1,41 @@
+/**  R3BGTPCMapRegistry.h
+ * One pad plane map per detector type, shared by all the tasks of a job
+ **/
+#ifndef R3BGTPCMAPREGISTRY_H
+#define R3BGTPCMAPREGISTRY_H
+
+#include "R3BGTPCMap.h"
+
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+/**
+ * GTPC map registry
+ *
+ * Generating the pad plane (one TH2Poly bin per pad and its partition) is done
+ * once per detector type (R3BGTPCGeoPar::GetDetectorType: 1 Prototype,
+ * 2 FullBeamIn, 3 FullBeamOut), on the first request, and the map is then
+ * shared read-only by the tasks and their threads. The pad layout is read from
+ * $VMCWORKDIR/glad-tpc/params/GTPCPadPlane_<Prototype|FullBeamIn|FullBeamOut>.xml
+ * unless another file is set with SetLayoutFile. Tasks filling a pad plane
+ * histogram (event display) must work on a clone of GetPadPlane().
+ */
+class R3BGTPCMapRegistry
+{
+  public:
+    /** Generated map of a detector type; thread safe **/
+    static std::shared_ptr<const R3BGTPCMap> Get(Int_t detectorType);
+
+    /** Pad layout file of a detector type, used if its map has not been generated yet **/
+    static void SetLayoutFile(Int_t detectorType, const char* fileName);
+
+  private:
+    static std::mutex& GetMutex();
+    static std::map<Int_t, TString>& GetLayoutFiles();
+};
+
+#endif // R3BGTPCMAPREGISTRY_H
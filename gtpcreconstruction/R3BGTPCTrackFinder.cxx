@@ -59,54 +59,48 @@ void R3BGTPCTrackFinder::eventToClusters(TClonesArray* hitCA, PointCloud& cloud)
     }
 }
 
+void R3BGTPCTrackFinder::eventToClusters(TClonesArray* hitCA, PointArrays& cloud)
+{
+    Int_t nHits = hitCA->GetEntries();
+    cloud.clear();
+    cloud.reserve(nHits);
+    for (Int_t iHit = 0; iHit < nHits; iHit++)
+    {
+        R3BGTPCHitData* hitData = (R3BGTPCHitData*)(hitCA->At(iHit));
+        cloud.push_back(hitData->GetX(), hitData->GetY(), hitData->GetZ(), iHit);
+    }
+}
+
 std::unique_ptr<R3BGTPCTrackData> R3BGTPCTrackFinder::clustersToTrack(PointCloud& cloud,
                                                                       const std::vector<cluster_t>& clusters,
                                                                       TClonesArray* trackCA,
                                                                       TClonesArray* hitCA)
 {
+    PointArrays arrays(cloud);
+    return clustersToTrack(arrays, clusters, trackCA, hitCA);
+}
+
+std::unique_ptr<R3BGTPCTrackData> R3BGTPCTrackFinder::clustersToTrack(PointArrays& cloud,
+                                                                      const std::vector<cluster_t>& clusters,
+                                                                      TClonesArray* trackCA,
+                                                                      TClonesArray* hitCA)
+{
 
     std::vector<R3BGTPCTrackData> tracks;
-    std::vector<Point> points = cloud;
 
     for (size_t cluster_index = 0; cluster_index < clusters.size(); ++cluster_index)
     {
 
         R3BGTPCTrackData track; // One track per cluster
-     
 
         const std::vector<size_t>& point_indices = clusters[cluster_index];
         if (point_indices.size() == 0)
             continue;
 
-        // add points
+        // add points (hits of the ids of the points)
         for (std::vector<size_t>::const_iterator it = point_indices.begin(); it != point_indices.end(); ++it)
         {
-
-            const Point& point = cloud[*it];
-
-            Int_t nHits = hitCA->GetEntries();
-	    
-            R3BGTPCHitData** hitData;
-            hitData = new R3BGTPCHitData*[nHits];
-
-	    if (hitData){
-	      
-	      hitData[point.GetID()] = (R3BGTPCHitData*)(hitCA->At(point.GetID()));	      
-	      track.AddHit(*hitData[point.GetID()]);	           
-	      delete hitData;
-
-	    }
-
-            // remove current point from vector points
-            for (std::vector<Point>::iterator p = points.begin(); p != points.end(); p++)
-            {
-                if (*p == point)
-                {
-                    points.erase(p);
-                    break;
-                }
-	    }
-
+            track.AddHit(*(R3BGTPCHitData*)(hitCA->At(cloud.id[*it])));
         } // Point indices
 
         track.SetTrackId(cluster_index);
@@ -115,7 +109,7 @@ std::unique_ptr<R3BGTPCTrackData> R3BGTPCTrackFinder::clustersToTrack(PointCloud
         tracks.push_back(track);
 
     } // Clusters loop
-    
+
     std::cout << cRED << " Tracks found " << tracks.size() << cNORMAL << "\n";
 
     // TODO
@@ -35,7 +35,9 @@ class R3BGTPCTrackFinder{
   virtual ~R3BGTPCTrackFinder() = default;
   void Clusterize(R3BGTPCTrackData &track, Float_t distance, Float_t radius);
   void eventToClusters(TClonesArray* hitCA, PointCloud& cloud);
+  void eventToClusters(TClonesArray* hitCA, PointArrays& cloud);
   std::unique_ptr<R3BGTPCTrackData> clustersToTrack(PointCloud &cloud, const std::vector<cluster_t> &clusters, TClonesArray* trackCA, TClonesArray* hitCA);
+  std::unique_ptr<R3BGTPCTrackData> clustersToTrack(PointArrays &cloud, const std::vector<cluster_t> &clusters, TClonesArray* trackCA, TClonesArray* hitCA);
 
   void SetScluster(float s) { inputParams.s = s; }
   void SetKtriplet(size_t k) { inputParams.k = k; }
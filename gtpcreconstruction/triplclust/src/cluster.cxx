@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <thread>
 
 #include "cluster.h"
 #include "hclust/fastcluster.h"
@@ -62,15 +63,271 @@ void calculate_distance_matrix(const std::vector<triplet>& triplets,
     }
 }
 
+// rows first_row..last_row-1 of the condensed distance matrix
+static void calculate_distance_rows(const TripletArrays& arrays,
+                                    double* result,
+                                    const ScaleTripletMetric& triplet_metric,
+                                    size_t first_row,
+                                    size_t last_row)
+{
+    const size_t n = arrays.size();
+    for (size_t i = first_row; i < last_row; ++i)
+    {
+        // row i starts after the i previous rows of n-1, n-2, ... entries
+        triplet_metric(arrays, i, i + 1, n, result + i * (2 * n - i - 1) / 2);
+    }
+}
+
+//-------------------------------------------------------------------
+// computation of condensed distance matrix with *num_threads* threads
+// (0 for all hardware threads).
+// Same matrix as above up to rounding, computed from the triplet
+// centers and directions as separate arrays. The rows are split in
+// contiguous blocks with about the same number of pairs per thread.
+//-------------------------------------------------------------------
+void calculate_distance_matrix(const std::vector<triplet>& triplets,
+                               double* result,
+                               double s,
+                               int num_threads)
+{
+    const size_t n = triplets.size();
+    if (n < 2)
+        return;
+    const TripletArrays arrays(triplets);
+    const ScaleTripletMetric triplet_metric(s);
+
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    // no more threads than rows
+    const size_t nthreads = std::min((size_t)num_threads, n - 1);
+
+    // row boundaries: block b ends at the row where the pairs reach b/nthreads of the total
+    const double total = 0.5 * n * (n - 1.0);
+    std::vector<size_t> bounds(nthreads + 1, n - 1);
+    bounds[0] = 0;
+    size_t row = 0;
+    double pairs = 0.0;
+    for (size_t b = 1; b < nthreads; ++b)
+    {
+        const double target = total * b / nthreads;
+        while (row < n - 1 && pairs < target)
+            pairs += n - 1 - row++;
+        bounds[b] = row;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(nthreads - 1);
+    for (size_t b = 1; b < nthreads; ++b)
+        workers.emplace_back(
+            calculate_distance_rows, std::cref(arrays), result, std::cref(triplet_metric), bounds[b], bounds[b + 1]);
+    calculate_distance_rows(arrays, result, triplet_metric, bounds[0], bounds[1]);
+    for (size_t b = 0; b < workers.size(); ++b)
+        workers[b].join();
+}
+
+// candidate link between two triplets
+struct TripletEdge
+{
+    size_t a, b;
+    double weight;
+    bool operator<(const TripletEdge& e2) const { return this->weight < e2.weight; };
+};
+
+// triplet index and grid cell of its center
+struct CellEntry
+{
+    long long cell[3];
+    size_t index;
+};
+
+// lexicographic order of the cells
+static bool cell_less(const CellEntry& lhs, const CellEntry& rhs)
+{
+    for (int d = 0; d < 3; ++d)
+    {
+        if (lhs.cell[d] != rhs.cell[d])
+            return lhs.cell[d] < rhs.cell[d];
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------
+// computation of the candidate links for sparse single linkage.
+// The triplet centers are sorted into a grid of cubic cells of size
+// *radius*. Only the pairs in the same or in adjacent cells are tested
+// and the ones with center distance <= *radius* and dissimilarity
+// < *t* are returned in *edges*.
+//-------------------------------------------------------------------
+static void calculate_sparse_edges(const std::vector<triplet>& triplets,
+                                   std::vector<TripletEdge>& edges,
+                                   ScaleTripletMetric& triplet_metric,
+                                   double t,
+                                   double radius)
+{
+    size_t const triplet_size = triplets.size();
+    const double radius2 = radius * radius;
+
+    double lower_x = triplets[0].center.x, lower_y = triplets[0].center.y, lower_z = triplets[0].center.z;
+    for (size_t i = 1; i < triplet_size; ++i)
+    {
+        lower_x = std::min(lower_x, triplets[i].center.x);
+        lower_y = std::min(lower_y, triplets[i].center.y);
+        lower_z = std::min(lower_z, triplets[i].center.z);
+    }
+    std::vector<CellEntry> grid(triplet_size);
+    for (size_t i = 0; i < triplet_size; ++i)
+    {
+        const Point& c = triplets[i].center;
+        grid[i].cell[0] = (long long)std::floor((c.x - lower_x) / radius);
+        grid[i].cell[1] = (long long)std::floor((c.y - lower_y) / radius);
+        grid[i].cell[2] = (long long)std::floor((c.z - lower_z) / radius);
+        grid[i].index = i;
+    }
+    std::sort(grid.begin(), grid.end(), cell_less);
+
+    // loop over the occupied cells and their neighbours
+    size_t first = 0;
+    while (first < triplet_size)
+    {
+        size_t last = first + 1;
+        while (last < triplet_size && !cell_less(grid[first], grid[last]))
+            ++last;
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    CellEntry neighbour = grid[first];
+                    neighbour.cell[0] += dx;
+                    neighbour.cell[1] += dy;
+                    neighbour.cell[2] += dz;
+                    std::pair<std::vector<CellEntry>::iterator, std::vector<CellEntry>::iterator> range =
+                        std::equal_range(grid.begin(), grid.end(), neighbour, cell_less);
+                    for (size_t i = first; i < last; ++i)
+                    {
+                        const triplet& lhs = triplets[grid[i].index];
+                        for (std::vector<CellEntry>::iterator other = range.first; other != range.second; ++other)
+                        {
+                            // each pair once
+                            if (other->index <= grid[i].index)
+                                continue;
+                            const triplet& rhs = triplets[other->index];
+                            if ((rhs.center - lhs.center).squared_norm() > radius2)
+                                continue;
+                            const double distance = triplet_metric(lhs, rhs);
+                            if (distance < t)
+                            {
+                                TripletEdge e = { grid[i].index, other->index, distance };
+                                edges.push_back(e);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        first = last;
+    }
+}
+
+// root of the set of *i* in the union-find forest *parent*
+static size_t find_root(std::vector<size_t>& parent, size_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]]; // path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+//-------------------------------------------------------------------
+// Sparse single linkage clustering with the fixed threshold *t*.
+// The minimum spanning forest of the candidate links is computed
+// with Kruskal's algorithm, so that the clusters are the ones of the
+// dendrogram cut at *t* as long as all triplet pairs with
+// dissimilarity < *t* have centers closer than *radius*. Memory is
+// linear in the number of triplets. The cluster labels are numbered
+// as by cutree_k, in order of their first triplet.
+//-------------------------------------------------------------------
+static void compute_sparse_hc(cluster_group& result,
+                              const std::vector<triplet>& triplets,
+                              double s,
+                              double t,
+                              double radius,
+                              int opt_verbose)
+{
+    const size_t triplet_size = triplets.size();
+    ScaleTripletMetric metric(s);
+    std::vector<TripletEdge> edges;
+    calculate_sparse_edges(triplets, edges, metric, t, radius);
+    std::sort(edges.begin(), edges.end());
+
+    // Kruskal: links of the minimum spanning forest below t
+    std::vector<size_t> parent(triplet_size);
+    for (size_t i = 0; i < triplet_size; ++i)
+        parent[i] = i;
+    std::vector<double> cdists;
+    for (std::vector<TripletEdge>::const_iterator e = edges.begin(); e != edges.end(); ++e)
+    {
+        size_t root_a = find_root(parent, e->a), root_b = find_root(parent, e->b);
+        if (root_a != root_b)
+        {
+            parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+            cdists.push_back(e->weight);
+        }
+    }
+
+    // generate clusters
+    std::vector<long> labels(triplet_size, -1);
+    for (size_t i = 0; i < triplet_size; ++i)
+    {
+        size_t root = find_root(parent, i);
+        if (labels[root] < 0)
+        {
+            labels[root] = result.size();
+            result.push_back(cluster_t());
+        }
+        result[labels[root]].push_back(i);
+    }
+
+    if (opt_verbose > 0)
+    {
+        std::cout << "[Info] sparse clustering: " << edges.size() << " links below t, " << result.size()
+                  << " clusters" << std::endl;
+    }
+    if (opt_verbose > 1)
+    {
+        // write debug file (merge distances below t)
+        const char* fname = "debug_cdist.csv";
+        std::ofstream of(fname);
+        of << std::fixed; // set float style
+        if (of.is_open())
+        {
+            for (size_t i = 0; i < cdists.size(); ++i)
+            {
+                of << cdists[i] << std::endl;
+            }
+        }
+        else
+        {
+            std::cerr << "[Error] could not write file '" << fname << "'\n";
+        }
+        of.close();
+    }
+}
+
 //-------------------------------------------------------------------
 // Computation of the clustering.
 // The triplets in *triplets* are clustered by the fastcluster algorithm
 // and the result is returned as cluster_group. *t* is the cut distance
 // and *triplet_metric* is the distance metric for the triplets.
 // *opt_verbose* is the verbosity level for debug outputs. the clustering
-// is returned in *result*.
+// is returned in *result*. With *sparse_radius* > 0, single linkage with
+// a fixed *t* is computed without the distance matrix (compute_sparse_hc).
+// Otherwise the distance matrix is computed with *num_threads* threads.
 //-------------------------------------------------------------------
-void compute_hc(const PointCloud& cloud,
+void compute_hc(const PointCloud& /*cloud*/,
                 cluster_group& result,
                 const std::vector<triplet>& triplets,
                 double s,
@@ -79,7 +336,25 @@ void compute_hc(const PointCloud& cloud,
                 double dmax,
                 bool is_dmax,
                 Linkage method,
-                int opt_verbose)
+                int opt_verbose,
+                double sparse_radius,
+                int num_threads)
+{
+    compute_hc(result, triplets, s, t, tauto, dmax, is_dmax, method, opt_verbose, sparse_radius, num_threads);
+}
+
+// same clustering; only the triplets are needed
+void compute_hc(cluster_group& result,
+                const std::vector<triplet>& triplets,
+                double s,
+                double t,
+                bool tauto,
+                double dmax,
+                bool is_dmax,
+                Linkage method,
+                int opt_verbose,
+                double sparse_radius,
+                int num_threads)
 {
     const size_t triplet_size = triplets.size();
     size_t k, cluster_size;
@@ -90,6 +365,16 @@ void compute_hc(const PointCloud& cloud,
         // if no triplets are generated
         return;
     }
+    if (sparse_radius > 0.0)
+    {
+        if (method == SINGLE && !tauto)
+        {
+            compute_sparse_hc(result, triplets, s, t, sparse_radius, opt_verbose);
+            return;
+        }
+        std::cerr << "[Warning] sparse clustering needs single linkage and a fixed t, "
+                  << "using the distance matrix" << std::endl;
+    }
     // choose linkage method
     switch (method)
     {
@@ -107,8 +392,7 @@ void compute_hc(const PointCloud& cloud,
     double* distance_matrix = new double[(triplet_size * (triplet_size - 1)) / 2];
     double* cdists = new double[triplet_size - 1];
     int *merge = new int[2 * (triplet_size - 1)], *labels = new int[triplet_size];
-    ScaleTripletMetric metric(s);
-    calculate_distance_matrix(triplets, cloud, distance_matrix, metric);
+    calculate_distance_matrix(triplets, distance_matrix, s, num_threads);
 
     hclust_fast(triplet_size, distance_matrix, link, merge, cdists);
 
@@ -303,3 +587,51 @@ void add_clusters(PointCloud& cloud, cluster_group& cl_group, bool gnuplot)
         cl_group.insert(cl_group.end(), verticies.begin(), verticies.end());
     }
 }
+
+//-------------------------------------------------------------------
+// Adds the cluster ids to the points in *cloud*
+// *cl_group* contains the clusters with the point indices. The ids of
+// the clusters of every point are saved in compressed sparse rows
+// (PointArrays::cluster_start and PointArrays::cluster_ids).
+//-------------------------------------------------------------------
+void add_clusters(PointArrays& cloud, const cluster_group& cl_group)
+{
+    std::vector<size_t>& start = cloud.cluster_start;
+    std::vector<size_t>& ids = cloud.cluster_ids;
+
+    // number of clusters per point, as offsets; a point listed twice in
+    // a cluster is counted once (*last* is the last cluster + 1 counted)
+    std::vector<size_t> last(cloud.size(), 0);
+    start.assign(cloud.size() + 1, 0);
+    for (size_t i = 0; i < cl_group.size(); ++i)
+    {
+        for (cluster_t::const_iterator point_index = cl_group[i].begin(); point_index != cl_group[i].end();
+             ++point_index)
+        {
+            if (last[*point_index] != i + 1)
+            {
+                last[*point_index] = i + 1;
+                ++start[*point_index + 1];
+            }
+        }
+    }
+    for (size_t i = 0; i < cloud.size(); ++i)
+    {
+        start[i + 1] += start[i];
+    }
+
+    // the clusters in increasing order, as in Point::cluster_ids
+    ids.resize(start[cloud.size()]);
+    std::vector<size_t>& next = last;
+    next.assign(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < cl_group.size(); ++i)
+    {
+        for (cluster_t::const_iterator point_index = cl_group[i].begin(); point_index != cl_group[i].end();
+             ++point_index)
+        {
+            size_t& position = next[*point_index];
+            if (position == start[*point_index] || ids[position - 1] != i)
+                ids[position++] = i;
+        }
+    }
+}
@@ -21,7 +21,15 @@ typedef std::vector<size_t> cluster_t;
 
 typedef std::vector<cluster_t> cluster_group;
 
-// compute hierarchical clustering
+// condensed distance matrix of the triplets, one triplet after the other
+void calculate_distance_matrix(const std::vector<triplet>& triplets,
+                               const PointCloud& cloud,
+                               double* result,
+                               ScaleTripletMetric& triplet_metric);
+// same matrix computed with num_threads threads (0 for all hardware threads)
+void calculate_distance_matrix(const std::vector<triplet>& triplets, double* result, double s, int num_threads);
+// compute hierarchical clustering; with sparse_radius > 0, single linkage
+// with fixed t only between triplets with centers closer than sparse_radius
 void compute_hc(const PointCloud& cloud,
                 cluster_group& result,
                 const std::vector<triplet>& triplets,
@@ -31,11 +39,28 @@ void compute_hc(const PointCloud& cloud,
                 double dmax = 0,
                 bool is_dmax = false,
                 Linkage method = SINGLE,
-                int opt_verbose = 0);
+                int opt_verbose = 0,
+                double sparse_radius = 0.0,
+                int num_threads = 1);
+// same without the cloud, which the clustering does not use
+void compute_hc(cluster_group& result,
+                const std::vector<triplet>& triplets,
+                double s,
+                double t,
+                bool tauto = false,
+                double dmax = 0,
+                bool is_dmax = false,
+                Linkage method = SINGLE,
+                int opt_verbose = 0,
+                double sparse_radius = 0.0,
+                int num_threads = 1);
 // remove all small clusters
 void cleanup_cluster_group(cluster_group& cg, size_t m, int opt_verbose = 0);
 // convert the triplet indices ind *cl_group* to point indices.
 void cluster_triplets_to_points(const std::vector<triplet>& triplets, cluster_group& cl_group);
 // adds the cluster ids to the points in *cloud*
 void add_clusters(PointCloud& cloud, cluster_group& cl_group, bool gnuplot = false);
+// stores the cluster ids of the points in the CSR arrays of *cloud*
+// (without the gnuplot vertex clusters of the PointCloud version)
+void add_clusters(PointArrays& cloud, const cluster_group& cl_group);
 #endif
@@ -8,48 +8,38 @@
 //
 
 #include <algorithm>
-#include <numeric>
 #include <vector>
 
 #include "dnn.h"
-#include "kdtree/kdtree.h"
+#include "pointtree.h"
 
 //-------------------------------------------------------------------
 // Compute mean squared distances.
 // the distances is computed for every point in *cloud* to its *k*
-// nearest neighbours. The distances are returned in *msd*.
+// nearest neighbours found in *tree*. The distances are returned in *msd*.
 //-------------------------------------------------------------------
-void compute_mean_square_distance(const PointCloud& cloud, std::vector<double>& msd, int k)
+template <class Cloud>
+void compute_mean_square_distance(const Cloud& cloud, const PointTree& tree, std::vector<double>& msd, int k)
 {
     // compute mean square distances for every point to its k nearest neighbours
-    Kdtree::KdNodeVector nodes, result;
+    std::vector<PointNeighbor> result;
     double sum;
 
-    // build kdtree
-    for (size_t i = 0; i < cloud.size(); ++i)
-    {
-        nodes.push_back(cloud[i].as_vector());
-    }
-    Kdtree::KdTree kdtree(&nodes);
-
     k++; // k must be one higher because the first point found by the kdtree is
          // the point itself
 
     for (size_t i = 0; i < cloud.size(); ++i)
     {
-        // compute
-        std::vector<double> squared_distances;
-        kdtree.k_nearest_neighbors(cloud[i].as_vector(), k, &result, &squared_distances);
+        tree.k_nearest_neighbors(point_x(cloud, i), point_y(cloud, i), point_z(cloud, i), k, result);
 
-        squared_distances.erase(squared_distances.begin()); // The first value
-                                                            // must be deleted
-                                                            // because it is
-                                                            // the distance
-                                                            // with the point
-                                                            // itself
-
-        sum = std::accumulate(squared_distances.begin(), squared_distances.end(), 0.0);
-        msd.push_back(sum / squared_distances.size());
+        // The first value must be skipped because it is the distance
+        // with the point itself
+        sum = 0.0;
+        for (size_t j = 1; j < result.size(); ++j)
+        {
+            sum += result[j].sqdist;
+        }
+        msd.push_back(sum / (result.size() - 1));
     }
 }
 
@@ -58,10 +48,26 @@ void compute_mean_square_distance(const PointCloud& cloud, std::vector<double>&
 // in *cloud*
 //-------------------------------------------------------------------
 double first_quartile(const PointCloud& cloud)
+{
+    PointTree tree(cloud);
+    return first_quartile(cloud, tree);
+}
+
+//-------------------------------------------------------------------
+// Compute first quartile of the mean squared distance of all points
+// in *cloud* (PointCloud or PointArrays), with the kd-tree *tree*
+// built over *cloud*
+//-------------------------------------------------------------------
+template <class Cloud>
+static double first_quartile_of(const Cloud& cloud, const PointTree& tree)
 {
     std::vector<double> msd;
-    compute_mean_square_distance(cloud, msd, 1);
+    compute_mean_square_distance(cloud, tree, msd, 1);
     const double q1 = msd.size() / 4;
     std::nth_element(msd.begin(), msd.begin() + q1, msd.end());
     return msd[q1];
 }
+
+double first_quartile(const PointCloud& cloud, const PointTree& tree) { return first_quartile_of(cloud, tree); }
+
+double first_quartile(const PointArrays& cloud, const PointTree& tree) { return first_quartile_of(cloud, tree); }
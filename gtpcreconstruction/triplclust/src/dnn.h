@@ -10,8 +10,12 @@
 #ifndef DNN_H
 #define DNN_H
 #include "pointcloud.h"
+#include "pointtree.h"
 
 // compute first quartile of the mean squared distance from the points
 double first_quartile(const PointCloud& cloud);
+// same with the kd-tree *tree* built over *cloud*
+double first_quartile(const PointCloud& cloud, const PointTree& tree);
+double first_quartile(const PointArrays& cloud, const PointTree& tree);
 
 #endif
@@ -22,20 +22,22 @@ struct Edge
 };
 
 // Create edges with weights between all point indices in *cluster*. the
-// weights are the distances of the points in *cloud*.  The edges are returned
-// in *edges*.
-void create_edges(std::vector<Edge>& edges, const PointCloud& cloud, const std::vector<size_t>& cluster)
+// weights are the distances of the points in *cloud* (PointCloud or
+// PointArrays).  The edges are returned in *edges*.
+template <class Cloud>
+void create_edges(std::vector<Edge>& edges, const Cloud& cloud, const std::vector<size_t>& cluster)
 {
     for (size_t vertex1 = 0; vertex1 < cluster.size(); ++vertex1)
     {
         for (size_t vertex2 = vertex1 + 1; vertex2 < cluster.size(); ++vertex2)
         {
             size_t point_index1 = cluster[vertex1], point_index2 = cluster[vertex2];
-            const Point& p = cloud[point_index1];
-            const Point& q = cloud[point_index2];
+            const double dx = point_x(cloud, point_index2) - point_x(cloud, point_index1);
+            const double dy = point_y(cloud, point_index2) - point_y(cloud, point_index1);
+            const double dz = point_z(cloud, point_index2) - point_z(cloud, point_index1);
 
             // compute squared distance
-            double distance = (q - p).squared_norm();
+            double distance = (dx * dx) + (dy * dy) + (dz * dz);
 
             Edge e = { vertex1, vertex2, distance };
             edges.push_back(e);
@@ -137,11 +139,12 @@ void dfs_util(std::vector<size_t>& new_cluster,
 // removed with a wheigth > *dmax*. The connected comonents are computed
 // and returned as new clusters if their size is >= *min_size*.
 //-------------------------------------------------------------------
-void max_step(std::vector<std::vector<size_t>>& new_clusters,
-              const std::vector<size_t>& cluster,
-              const PointCloud& cloud,
-              double dmax,
-              size_t min_size)
+template <class Cloud>
+static void split_at_gaps(std::vector<std::vector<size_t>>& new_clusters,
+                          const std::vector<size_t>& cluster,
+                          const Cloud& cloud,
+                          double dmax,
+                          size_t min_size)
 {
     size_t vcount = cluster.size();
     double tstart;
@@ -163,3 +166,21 @@ void max_step(std::vector<std::vector<size_t>>& new_clusters,
         }
     }
 }
+
+void max_step(std::vector<std::vector<size_t>>& new_clusters,
+              const std::vector<size_t>& cluster,
+              const PointCloud& cloud,
+              double dmax,
+              size_t min_size)
+{
+    split_at_gaps(new_clusters, cluster, cloud, dmax, min_size);
+}
+
+void max_step(std::vector<std::vector<size_t>>& new_clusters,
+              const std::vector<size_t>& cluster,
+              const PointArrays& cloud,
+              double dmax,
+              size_t min_size)
+{
+    split_at_gaps(new_clusters, cluster, cloud, dmax, min_size);
+}
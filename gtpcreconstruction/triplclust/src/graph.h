@@ -24,5 +24,10 @@ void max_step(std::vector<std::vector<size_t> >& new_clusters,
               const PointCloud& cloud,
               double dmax,
               size_t min_size);
+void max_step(std::vector<std::vector<size_t> >& new_clusters,
+              const std::vector<size_t>& cluster,
+              const PointArrays& cloud,
+              double dmax,
+              size_t min_size);
 
 #endif
@@ -39,6 +39,13 @@ const char* usage = "Usage:\n"
                     "\t               (can be numeric, multiple of dNN or 'none')\n"
                     "\t-link <method> linkage method for clustering [single]\n"
                     "\t               (can be 'single', 'complete', 'average')\n"
+                    "\t-sparse <n>    single linkage only between triplets whose\n"
+                    "\t               centers are closer than n, without distance\n"
+                    "\t               matrix (needs '-link single' and fixed t) [none]\n"
+                    "\t               (can be numeric, multiple of dNN or 'none')\n"
+                    "\t-threads <n>   threads for the triplets and the distance\n"
+                    "\t               matrix [1]\n"
+                    "\t               (0 for all hardware threads)\n"
                     "\t-oprefix <prefix>\n"
                     "\t               write result not to stdout, but to <prefix>.csv\n"
                     "\t               and (if -gnuplot is set) to <prefix>.gnuplot\n"
@@ -135,7 +142,12 @@ int main(int argc, char** argv)
 
     // Step 2) finding triplets of approximately collinear points
     std::vector<triplet> triplets;
-    generate_triplets(cloud_xyz_smooth, triplets, opt_params.get_k(), opt_params.get_n(), opt_params.get_a());
+    generate_triplets(cloud_xyz_smooth,
+                      triplets,
+                      opt_params.get_k(),
+                      opt_params.get_n(),
+                      opt_params.get_a(),
+                      opt_params.get_threads());
 
     // Step 3) single link hierarchical clustering of the triplets
     cluster_group cl_group;
@@ -148,7 +160,9 @@ int main(int argc, char** argv)
                opt_params.get_dmax(),
                opt_params.is_dmax(),
                opt_params.get_linkage(),
-               opt_verbose);
+               opt_verbose,
+               opt_params.is_sparse() ? opt_params.get_sparse() : 0.0,
+               opt_params.get_threads());
 
     // Step 4) pruning by removal of small clusters ...
     cleanup_cluster_group(cl_group, opt_params.get_m(), opt_verbose);
@@ -42,6 +42,10 @@ Opt::Opt()
     this->isdmax = false;
     this->dmax_dnn = false;
     this->link = SINGLE;
+    this->sparse = 0.0;
+    this->issparse = false;
+    this->sparse_dnn = false;
+    this->threads = 1;
 
     this->m = 15;
 }
@@ -220,6 +224,47 @@ int Opt::parse_args(int argc, char** argv)
                     return 1;
                 }
             }
+            else if (0 == strcmp(argv[i], "-sparse"))
+            {
+                ++i;
+                if (i >= argc)
+                {
+                    return 1;
+                }
+                if (strcmp(argv[i], "none") == 0)
+                {
+                    this->issparse = false;
+                }
+                else
+                {
+                    tmp = this->parse_argument(argv[i]);
+                    this->sparse = tmp.first;
+                    this->sparse_dnn = tmp.second;
+                    this->issparse = true;
+                }
+            }
+            else if (0 == strcmp(argv[i], "-threads"))
+            {
+                ++i;
+                if (i < argc)
+                {
+                    int tmp = atoi(argv[i]);
+                    if (tmp < 0)
+                    {
+                        std::cerr << "[Error] threads takes only positive integers. parameter "
+                                     "is ignored!"
+                                  << std::endl;
+                    }
+                    else
+                    {
+                        this->threads = tmp;
+                    }
+                }
+                else
+                {
+                    return 1;
+                }
+            }
             else if (0 == strcmp(argv[i], "-skip"))
             {
                 ++i;
@@ -305,7 +350,7 @@ std::pair<double, bool> Opt::parse_argument(const char* str)
 
 //-------------------------------------------------------------------
 // compute attributes which depend on dnn.
-// If r,s,dmax depend on dnn their new value will be computed.
+// If r,s,dmax,sparse depend on dnn their new value will be computed.
 //-------------------------------------------------------------------
 void Opt::set_dnn(double dnn)
 {
@@ -333,12 +378,47 @@ void Opt::set_dnn(double dnn)
             std::cout << "[Info] computed max gap: " << this->dmax << std::endl;
         }
     }
+    if (this->sparse_dnn)
+    {
+        this->sparse *= dnn;
+        if (this->verbose > 0)
+        {
+            std::cout << "[Info] computed sparse radius: " << this->sparse << std::endl;
+        }
+    }
+}
+
+//-------------------------------------------------------------------
+// sets the sparse radius as the command line option -sparse.
+// A radius <= 0 disables sparse clustering.
+//-------------------------------------------------------------------
+void Opt::set_sparse(double sparse, bool dnn)
+{
+    this->issparse = sparse > 0.0;
+    this->sparse = this->issparse ? sparse : 0.0;
+    this->sparse_dnn = this->issparse && dnn;
+}
+
+//-------------------------------------------------------------------
+// sets the threads as the command line option -threads.
+// Negative numbers are ignored.
+//-------------------------------------------------------------------
+void Opt::set_threads(int threads)
+{
+    if (threads < 0)
+    {
+        std::cerr << "[Error] threads takes only positive integers. parameter "
+                     "is ignored!"
+                  << std::endl;
+        return;
+    }
+    this->threads = threads;
 }
 
 // read access functions
 const char* Opt::get_ifname() { return this->infile_name; }
 const char* Opt::get_ofprefix() { return this->outfile_prefix; }
-bool Opt::needs_dnn() { return this->rdnn || this->sdnn || this->dmax_dnn; }
+bool Opt::needs_dnn() { return this->rdnn || this->sdnn || this->dmax_dnn || this->sparse_dnn; }
 bool Opt::is_gnuplot() { return this->gnuplot; }
 size_t Opt::get_skip() { return this->skip; }
 char Opt::get_delimiter() { return this->delimiter; }
@@ -353,4 +433,7 @@ double Opt::get_t() { return this->t; }
 bool Opt::is_dmax() { return this->isdmax; }
 double Opt::get_dmax() { return this->dmax; }
 Linkage Opt::get_linkage() { return this->link; }
+bool Opt::is_sparse() { return this->issparse; }
+double Opt::get_sparse() { return this->sparse; }
+int Opt::get_threads() { return this->threads; }
 size_t Opt::get_m() { return this->m; }
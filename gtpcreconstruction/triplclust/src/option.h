@@ -51,6 +51,12 @@ class Opt
     bool dmax_dnn; // use dnn for dmax
     // linkage method for clustering
     Linkage link;
+    // max triplet center distance for sparse single linkage
+    double sparse;
+    bool issparse;   // sparse != none
+    bool sparse_dnn; // use dnn for sparse
+    // threads for the triplets and the distance matrix (0 for all hardware threads)
+    int threads;
 
     // min number of triplets per cluster
     size_t m;
@@ -62,6 +68,11 @@ class Opt
     int parse_args(int argc, char** argv);
     // compute attributes which depend on dnn.
     void set_dnn(double dnn);
+    // max triplet center distance for sparse single linkage (<= 0 for none),
+    // as a multiple of dnn if *dnn* is set
+    void set_sparse(double sparse, bool dnn);
+    // threads for the triplets and the distance matrix (0 for all hardware threads)
+    void set_threads(int threads);
 
     // read access functions
     const char* get_ifname();
@@ -82,6 +93,9 @@ class Opt
     bool is_dmax();
     double get_dmax();
     Linkage get_linkage();
+    bool is_sparse();
+    double get_sparse();
+    int get_threads();
     size_t get_m();
 };
 
@@ -14,8 +14,8 @@
 #include <stdexcept>
 #include <string>
 
-#include "kdtree/kdtree.h"
 #include "pointcloud.h"
+#include "pointtree.h"
 #include "util.h"
 
 // a single 3D point
@@ -131,6 +131,59 @@ void PointCloud::set2d(bool is2d) { this->points2d = is2d; }
 
 bool PointCloud::is2d() const { return this->points2d; }
 
+PointArrays::PointArrays() {}
+
+PointArrays::PointArrays(const PointCloud& cloud)
+{
+    this->reserve(cloud.size());
+    for (size_t i = 0; i < cloud.size(); ++i)
+    {
+        this->push_back(cloud[i].x, cloud[i].y, cloud[i].z, cloud[i].id);
+    }
+}
+
+void PointArrays::reserve(size_t n)
+{
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    id.reserve(n);
+}
+
+void PointArrays::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    id.clear();
+    cluster_start.clear();
+    cluster_ids.clear();
+}
+
+void PointArrays::push_back(double px, double py, double pz, int pid)
+{
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+    id.push_back(pid);
+}
+
+void PointArrays::to_cloud(PointCloud& cloud) const
+{
+    cloud.clear();
+    cloud.reserve(this->size());
+    for (size_t i = 0; i < this->size(); ++i)
+    {
+        cloud.emplace_back(x[i], y[i], z[i]);
+        cloud.back().SetID(id[i]);
+        if (!cluster_start.empty())
+        {
+            cloud.back().cluster_ids.insert(cluster_ids.begin() + cluster_start[i],
+                                            cluster_ids.begin() + cluster_start[i + 1]);
+        }
+    }
+}
+
 // Split string *input* into substrings by *delimiter*. The result is
 // returned in *result*
 void split(const std::string& input, std::vector<std::string>& result, const char delimiter)
@@ -236,8 +289,6 @@ void load_csv_file(const char* fname, PointCloud& cloud, const char delimiter, s
 //-------------------------------------------------------------------
 void smoothen_cloud(const PointCloud& cloud, PointCloud& result_cloud, double r)
 {
-    Kdtree::KdNodeVector nodes;
-
     // If the smooth-radius is zero return the unsmoothed pointcloud
     if (r == 0)
     {
@@ -245,40 +296,84 @@ void smoothen_cloud(const PointCloud& cloud, PointCloud& result_cloud, double r)
         return;
     }
 
-    // build kdtree
-    for (size_t i = 0; i < cloud.size(); ++i)
+    PointTree tree(cloud);
+    smoothen_cloud(cloud, result_cloud, r, tree);
+}
+
+//-------------------------------------------------------------------
+// Smoothing of the PointCloud *cloud* with the neighbours found in
+// *tree*, which must be built over *cloud*.
+//-------------------------------------------------------------------
+void smoothen_cloud(const PointCloud& cloud, PointCloud& result_cloud, double r, const PointTree& tree)
+{
+    std::vector<size_t> result;
+
+    // If the smooth-radius is zero return the unsmoothed pointcloud
+    if (r == 0)
     {
-        nodes.push_back(cloud[i].as_vector());
+        result_cloud = cloud;
+        return;
     }
-    Kdtree::KdTree kdtree(&nodes);
 
     for (size_t i = 0; i < cloud.size(); ++i)
     {
-        size_t result_size;
-        Point new_point, point = cloud[i];
-        Kdtree::KdNodeVector result;
+        Point new_point;
+        double x = 0.0, y = 0.0, z = 0.0;
 
-        kdtree.range_nearest_neighbors(point.as_vector(), r, &result);
-        result_size = result.size();
+        tree.range_neighbors(cloud[i], r, result);
 
         // compute the centroid with mean
-        std::vector<double> x_list;
-        std::vector<double> y_list;
-        std::vector<double> z_list;
-
-        for (Kdtree::KdNodeVector::iterator it = result.begin(); it != result.end(); ++it)
+        for (std::vector<size_t>::const_iterator it = result.begin(); it != result.end(); ++it)
         {
-            x_list.push_back(it->point[0]);
-            y_list.push_back(it->point[1]);
-            z_list.push_back(it->point[2]);
+            x += cloud[*it].x;
+            y += cloud[*it].y;
+            z += cloud[*it].z;
         }
 
-        new_point.x = std::accumulate(x_list.begin(), x_list.end(), 0.0) / result_size;
+        new_point.x = x / result.size();
 
-        new_point.y = std::accumulate(y_list.begin(), y_list.end(), 0.0) / result_size;
+        new_point.y = y / result.size();
 
-        new_point.z = std::accumulate(z_list.begin(), z_list.end(), 0.0) / result_size;
+        new_point.z = z / result.size();
 
         result_cloud.push_back(new_point);
     }
 }
+
+//-------------------------------------------------------------------
+// Smoothing of the points *cloud* with the neighbours found in *tree*,
+// which must be built over *cloud*. The centroids are returned in
+// *result_cloud* with the ids of *cloud*.
+//-------------------------------------------------------------------
+void smoothen_cloud(const PointArrays& cloud, PointArrays& result_cloud, double r, const PointTree& tree)
+{
+    std::vector<size_t> result;
+
+    result_cloud.clear();
+    // If the smooth-radius is zero return the unsmoothed points
+    if (r == 0)
+    {
+        result_cloud.x = cloud.x;
+        result_cloud.y = cloud.y;
+        result_cloud.z = cloud.z;
+        result_cloud.id = cloud.id;
+        return;
+    }
+
+    result_cloud.reserve(cloud.size());
+    for (size_t i = 0; i < cloud.size(); ++i)
+    {
+        double x = 0.0, y = 0.0, z = 0.0;
+
+        tree.range_neighbors(cloud.x[i], cloud.y[i], cloud.z[i], r, result);
+
+        // compute the centroid with mean
+        for (std::vector<size_t>::const_iterator it = result.begin(); it != result.end(); ++it)
+        {
+            x += cloud.x[*it];
+            y += cloud.y[*it];
+            z += cloud.z[*it];
+        }
+        result_cloud.push_back(x / result.size(), y / result.size(), z / result.size(), cloud.id[i]);
+    }
+}
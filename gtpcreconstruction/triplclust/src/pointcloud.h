@@ -71,9 +71,46 @@ class PointCloud : public std::vector<Point>
     PointCloud();
 };
 
+// The points of a cloud as separate arrays of coordinates and ids.
+// The clusters of the points are stored in compressed sparse rows (CSR):
+// the clusters of point i are cluster_ids[cluster_start[i]] to
+// cluster_ids[cluster_start[i+1]-1], in increasing order. cluster_start
+// is empty until add_clusters is called.
+struct PointArrays
+{
+    std::vector<double> x, y, z;
+    std::vector<int> id;
+    std::vector<size_t> cluster_start;
+    std::vector<size_t> cluster_ids;
+
+    PointArrays();
+    PointArrays(const PointCloud& cloud);
+    size_t size() const { return x.size(); }
+    void reserve(size_t n);
+    // removes all points, keeping the memory
+    void clear();
+    void push_back(double px, double py, double pz, int pid = -1);
+    // copy to *cloud*, with the clusters in Point::cluster_ids
+    void to_cloud(PointCloud& cloud) const;
+};
+
+// coordinates of point *i* of both layouts, for code written for both
+inline double point_x(const PointCloud& cloud, size_t i) { return cloud[i].x; }
+inline double point_y(const PointCloud& cloud, size_t i) { return cloud[i].y; }
+inline double point_z(const PointCloud& cloud, size_t i) { return cloud[i].z; }
+inline double point_x(const PointArrays& cloud, size_t i) { return cloud.x[i]; }
+inline double point_y(const PointArrays& cloud, size_t i) { return cloud.y[i]; }
+inline double point_z(const PointArrays& cloud, size_t i) { return cloud.z[i]; }
+
+class PointTree;
+
 // Load csv file.
 void load_csv_file(const char* fname, PointCloud& cloud, const char delimiter, size_t skip = 0);
 // Smoothing of the PointCloud *cloud*. The result is returned in *result_cloud*
 void smoothen_cloud(const PointCloud& cloud, PointCloud& result_cloud, double radius);
+// same with the kd-tree *tree* built over *cloud*
+void smoothen_cloud(const PointCloud& cloud, PointCloud& result_cloud, double radius, const PointTree& tree);
+// same for separate arrays; *result_cloud* is overwritten
+void smoothen_cloud(const PointArrays& cloud, PointArrays& result_cloud, double radius, const PointTree& tree);
 
 #endif
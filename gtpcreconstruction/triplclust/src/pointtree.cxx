@@ -0,0 +1,188 @@
+//
+// pointtree.cxx
+//     3D kd-tree over the points of a PointCloud, stored in flat
+//     arrays and shared by the neighbour searches of one cloud
+//
+// License: see ../LICENSE
+//
+
+#include <algorithm>
+
+#include "pointtree.h"
+
+// order of the nodes in one coordinate
+struct compare_coordinate
+{
+    size_t dim;
+    compare_coordinate(size_t d) { dim = d; }
+    template <class T>
+    bool operator()(const T& lhs, const T& rhs) const
+    {
+        return lhs.coord[dim] < rhs.coord[dim];
+    }
+};
+
+PointTree::PointTree() {}
+
+PointTree::PointTree(const PointCloud& cloud) { this->build(cloud); }
+
+PointTree::PointTree(const PointArrays& cloud) { this->build(cloud); }
+
+//-------------------------------------------------------------------
+// builds the tree over the points of *cloud*.
+// The nodes keep the point coordinates and their index in *cloud*.
+//-------------------------------------------------------------------
+void PointTree::build(const PointCloud& cloud)
+{
+    nodes.resize(cloud.size());
+    for (size_t i = 0; i < cloud.size(); ++i)
+    {
+        nodes[i].coord[0] = cloud[i].x;
+        nodes[i].coord[1] = cloud[i].y;
+        nodes[i].coord[2] = cloud[i].z;
+        nodes[i].index = i;
+    }
+    build_tree(0, 0, nodes.size());
+}
+
+// builds the tree over the points of *cloud*
+void PointTree::build(const PointArrays& cloud)
+{
+    nodes.resize(cloud.size());
+    for (size_t i = 0; i < cloud.size(); ++i)
+    {
+        nodes[i].coord[0] = cloud.x[i];
+        nodes[i].coord[1] = cloud.y[i];
+        nodes[i].coord[2] = cloud.z[i];
+        nodes[i].index = i;
+    }
+    build_tree(0, 0, nodes.size());
+}
+
+//-------------------------------------------------------------------
+// recursive build of the subtree of the nodes *a* to *b*-1: the median
+// in the coordinate depth % 3 is moved to (a+b)/2, the smaller
+// coordinates before and the larger ones after it
+//-------------------------------------------------------------------
+void PointTree::build_tree(size_t depth, size_t a, size_t b)
+{
+    if (b - a <= 1)
+        return;
+    const size_t m = (a + b) / 2;
+    std::nth_element(nodes.begin() + a, nodes.begin() + m, nodes.begin() + b, compare_coordinate(depth % 3));
+    build_tree(depth + 1, a, m);
+    build_tree(depth + 1, m + 1, b);
+}
+
+//-------------------------------------------------------------------
+// k nearest neighbor search.
+// The *k* nearest points to *point* are returned in *result*, sorted
+// by distance (ties by index). *result* is used as heap during the
+// search, so that it does not allocate when reused.
+//-------------------------------------------------------------------
+void PointTree::k_nearest_neighbors(const Point& point, size_t k, std::vector<PointNeighbor>& result) const
+{
+    this->k_nearest_neighbors(point.x, point.y, point.z, k, result);
+}
+
+void PointTree::k_nearest_neighbors(double x, double y, double z, size_t k, std::vector<PointNeighbor>& result) const
+{
+    const double coord[3] = { x, y, z };
+    result.clear();
+    if (k < 1)
+        return;
+    knn_search(coord, std::min(k, nodes.size()), 0, 0, nodes.size(), result);
+    std::sort_heap(result.begin(), result.end());
+}
+
+// recursive nearest neighbor search in the subtree of the nodes *a* to *b*-1.
+// *heap* is a max heap of the nearest points found so far
+void PointTree::knn_search(const double* point,
+                           size_t k,
+                           size_t depth,
+                           size_t a,
+                           size_t b,
+                           std::vector<PointNeighbor>& heap) const
+{
+    if (a >= b)
+        return;
+    const size_t m = (a + b) / 2;
+    const size_t dim = depth % 3;
+    const Node& node = nodes[m];
+
+    const double dx = node.coord[0] - point[0];
+    const double dy = node.coord[1] - point[1];
+    const double dz = node.coord[2] - point[2];
+    const PointNeighbor candidate = { node.index, dx * dx + dy * dy + dz * dz };
+    if (heap.size() < k)
+    {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    else if (candidate < heap.front())
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    // first the side of the point, then the other one if the ball of the
+    // k-th neighbour crosses the splitting plane
+    const double diff = point[dim] - node.coord[dim];
+    if (diff < 0)
+    {
+        knn_search(point, k, depth + 1, a, m, heap);
+        if (heap.size() < k || diff * diff <= heap.front().sqdist)
+            knn_search(point, k, depth + 1, m + 1, b, heap);
+    }
+    else
+    {
+        knn_search(point, k, depth + 1, m + 1, b, heap);
+        if (heap.size() < k || diff * diff <= heap.front().sqdist)
+            knn_search(point, k, depth + 1, a, m, heap);
+    }
+}
+
+//-------------------------------------------------------------------
+// range search.
+// The indices of the points within the distance *r* of *point* are
+// returned in *result*.
+//-------------------------------------------------------------------
+void PointTree::range_neighbors(const Point& point, double r, std::vector<size_t>& result) const
+{
+    this->range_neighbors(point.x, point.y, point.z, r, result);
+}
+
+void PointTree::range_neighbors(double x, double y, double z, double r, std::vector<size_t>& result) const
+{
+    const double coord[3] = { x, y, z };
+    result.clear();
+    range_search(coord, r * r, 0, 0, nodes.size(), result);
+}
+
+// recursive range search in the subtree of the nodes *a* to *b*-1
+void PointTree::range_search(const double* point,
+                             double sqr,
+                             size_t depth,
+                             size_t a,
+                             size_t b,
+                             std::vector<size_t>& result) const
+{
+    if (a >= b)
+        return;
+    const size_t m = (a + b) / 2;
+    const size_t dim = depth % 3;
+    const Node& node = nodes[m];
+
+    const double dx = node.coord[0] - point[0];
+    const double dy = node.coord[1] - point[1];
+    const double dz = node.coord[2] - point[2];
+    if (dx * dx + dy * dy + dz * dz <= sqr)
+        result.push_back(node.index);
+
+    const double diff = point[dim] - node.coord[dim];
+    if (diff <= 0 || diff * diff <= sqr)
+        range_search(point, sqr, depth + 1, a, m, result);
+    if (diff >= 0 || diff * diff <= sqr)
+        range_search(point, sqr, depth + 1, m + 1, b, result);
+}
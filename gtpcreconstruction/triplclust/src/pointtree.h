@@ -0,0 +1,75 @@
+//
+// pointtree.h
+//     3D kd-tree over the points of a PointCloud, stored in flat
+//     arrays and shared by the neighbour searches of one cloud
+//
+// License: see ../LICENSE
+//
+
+#ifndef POINTTREE_H
+#define POINTTREE_H
+#include <cstddef>
+#include <vector>
+
+#include "pointcloud.h"
+
+// neighbour found by a PointTree search
+struct PointNeighbor
+{
+    size_t index;  // index of the point in the cloud
+    double sqdist; // squared distance to the query point
+    // by distance, ties by index
+    bool operator<(const PointNeighbor& other) const
+    {
+        return sqdist < other.sqdist || (sqdist == other.sqdist && index < other.index);
+    }
+};
+
+// kd-tree of the points of a cloud with Euclidean distance.
+// The tree is balanced and implicit: the points are permuted such that
+// the node of the range [a,b) is at (a+b)/2, split in the coordinate
+// depth % 3, and the coordinates are kept inline. The searches do not
+// allocate once the result vectors have grown, and are const, so that
+// several threads can search the same tree.
+class PointTree
+{
+  private:
+    struct Node
+    {
+        double coord[3];
+        size_t index; // index of the point in the cloud
+    };
+    std::vector<Node> nodes; // points in tree order
+
+    void build_tree(size_t depth, size_t a, size_t b);
+    void knn_search(const double* point,
+                    size_t k,
+                    size_t depth,
+                    size_t a,
+                    size_t b,
+                    std::vector<PointNeighbor>& heap) const;
+    void range_search(const double* point,
+                      double sqr,
+                      size_t depth,
+                      size_t a,
+                      size_t b,
+                      std::vector<size_t>& result) const;
+
+  public:
+    PointTree();
+    PointTree(const PointCloud& cloud);
+    PointTree(const PointArrays& cloud);
+    // (re)builds the tree over *cloud*, reusing the memory of the last one
+    void build(const PointCloud& cloud);
+    void build(const PointArrays& cloud);
+    size_t size() const { return nodes.size(); }
+    // the *k* nearest points to *point* (including the point itself when
+    // it belongs to the cloud), sorted by distance
+    void k_nearest_neighbors(const Point& point, size_t k, std::vector<PointNeighbor>& result) const;
+    void k_nearest_neighbors(double x, double y, double z, size_t k, std::vector<PointNeighbor>& result) const;
+    // cloud indices of the points within distance *r* of *point*, in tree order
+    void range_neighbors(const Point& point, double r, std::vector<size_t>& result) const;
+    void range_neighbors(double x, double y, double z, double r, std::vector<size_t>& result) const;
+};
+
+#endif
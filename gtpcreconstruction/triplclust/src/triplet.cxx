@@ -10,8 +10,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <thread>
 
-#include "kdtree/kdtree.h"
 #include "triplet.h"
 
 //-------------------------------------------------------------------
@@ -20,78 +20,92 @@
 // of neighbores from a point, which are used for triplet generation.
 // *n* is the number of the best triplet candidates to use. This can
 // be lesser than *n*. *a* is the max error (1-angle) for the triplet
-// to be a triplet candidate.
+// to be a triplet candidate. The points are split over *num_threads*
+// threads (0 for all hardware threads).
 //-------------------------------------------------------------------
-void generate_triplets(const PointCloud& cloud, std::vector<triplet>& triplets, size_t k, size_t n, double a)
+void generate_triplets(
+    const PointCloud& cloud, std::vector<triplet>& triplets, size_t k, size_t n, double a, int num_threads)
 {
-    std::vector<double> distances;
-    Kdtree::KdNodeVector nodes, result;
-    std::vector<size_t> indices; // save the indices so that they can be used
-                                 // for the KdNode constructor
-    indices.resize(cloud.size(), 0);
-
-    // build kdtree
-    for (size_t i = 0; i < cloud.size(); ++i)
-    {
-        indices[i] = i;
-        nodes.push_back(Kdtree::KdNode(cloud[i].as_vector(), (void*)&indices[i]));
-    }
-    Kdtree::KdTree kdtree(&nodes);
+    PointTree tree(cloud);
+    generate_triplets(cloud, tree, triplets, k, n, a, num_threads);
+}
+
+//-------------------------------------------------------------------
+// Generates the triplets of the points *first* to *last*-1 of *cloud*
+// (PointCloud or PointArrays) with the neighbours found in *tree*,
+// which must be built over *cloud*, appended to *triplets*.
+// The vectors are computed component by component, as Point does.
+//-------------------------------------------------------------------
+template <class Cloud>
+static void generate_triplets_range(const Cloud& cloud,
+                                    const PointTree& tree,
+                                    std::vector<triplet>& triplets,
+                                    size_t k,
+                                    size_t n,
+                                    double a,
+                                    size_t first,
+                                    size_t last)
+{
+    std::vector<PointNeighbor> result;
+    std::vector<triplet> triplet_candidates;
 
-    for (size_t point_index_b = 0; point_index_b < cloud.size(); ++point_index_b)
+    for (size_t point_index_b = first; point_index_b < last; ++point_index_b)
     {
-        distances.clear();
-        Point point_b = cloud[point_index_b];
+        const double bx = point_x(cloud, point_index_b);
+        const double by = point_y(cloud, point_index_b);
+        const double bz = point_z(cloud, point_index_b);
 
-        std::vector<triplet> triplet_candidates;
+        triplet_candidates.clear();
 
-        kdtree.k_nearest_neighbors(cloud[point_index_b].as_vector(), k, &result, &distances);
+        tree.k_nearest_neighbors(bx, by, bz, k, result);
 
         for (size_t result_index_a = 1; result_index_a < result.size(); ++result_index_a)
         {
             // When the distance is 0, we have the same point as point_b
-            if (distances[result_index_a] == 0)
+            if (result[result_index_a].sqdist == 0)
                 continue;
-            Point point_a(result[result_index_a].point);
-            size_t point_index_a = *(size_t*)result[result_index_a].data;
+            size_t point_index_a = result[result_index_a].index;
+            const double ax = point_x(cloud, point_index_a);
+            const double ay = point_y(cloud, point_index_a);
+            const double az = point_z(cloud, point_index_a);
 
-            Point direction_ab = point_b - point_a;
-            double ab_norm = direction_ab.norm();
-            direction_ab = direction_ab / ab_norm;
+            double abx = bx - ax, aby = by - ay, abz = bz - az;
+            double ab_norm = std::sqrt((abx * abx) + (aby * aby) + (abz * abz));
+            abx = abx / ab_norm;
+            aby = aby / ab_norm;
+            abz = abz / ab_norm;
 
             for (size_t result_index_c = result_index_a + 1; result_index_c < result.size(); ++result_index_c)
             {
                 // When the distance is 0, we have the same point as point_b
-                if (distances[result_index_c] == 0)
+                if (result[result_index_c].sqdist == 0)
                     continue;
-                Point point_c = Point(result[result_index_c].point);
-                size_t point_index_c = *(size_t*)result[result_index_c].data;
+                size_t point_index_c = result[result_index_c].index;
+                const double cx = point_x(cloud, point_index_c);
+                const double cy = point_y(cloud, point_index_c);
+                const double cz = point_z(cloud, point_index_c);
 
-                Point direction_bc = point_c - point_b;
-                double bc_norm = direction_bc.norm();
-                direction_bc = direction_bc / bc_norm;
+                double bcx = cx - bx, bcy = cy - by, bcz = cz - bz;
+                double bc_norm = std::sqrt((bcx * bcx) + (bcy * bcy) + (bcz * bcz));
+                bcx = bcx / bc_norm;
+                bcy = bcy / bc_norm;
+                bcz = bcz / bc_norm;
 
-                const double angle = direction_ab * direction_bc;
+                const double angle = abx * bcx + aby * bcy + abz * bcz;
 
                 // calculate error
                 const double error = 1.0f - angle;
 
                 if (error <= a)
                 {
-                    // calculate center
-                    Point center = (point_a + point_b + point_c) / 3.0f;
-
-                    // calculate direction
-                    Point direction = point_c - point_b;
-                    direction = direction / direction.norm();
-
                     triplet new_triplet;
 
                     new_triplet.point_index_a = point_index_a;
                     new_triplet.point_index_b = point_index_b;
                     new_triplet.point_index_c = point_index_c;
-                    new_triplet.center = center;
-                    new_triplet.direction = direction;
+                    // center and direction
+                    new_triplet.center = Point((ax + bx + cx) / 3.0f, (ay + by + cy) / 3.0f, (az + bz + cz) / 3.0f);
+                    new_triplet.direction = Point(bcx, bcy, bcz);
                     new_triplet.error = error;
 
                     triplet_candidates.push_back(new_triplet);
@@ -110,6 +124,103 @@ void generate_triplets(const PointCloud& cloud, std::vector<triplet>& triplets,
     }
 }
 
+//-------------------------------------------------------------------
+// Generates triplets from *cloud* with *num_threads* threads (0 for all
+// hardware threads). The points are split in contiguous blocks, each
+// thread fills its own list of triplets and the lists are appended in
+// the order of the blocks, so that the result does not depend on the
+// number of threads.
+//-------------------------------------------------------------------
+template <class Cloud>
+static void generate_triplets_of(const Cloud& cloud,
+                                 const PointTree& tree,
+                                 std::vector<triplet>& triplets,
+                                 size_t k,
+                                 size_t n,
+                                 double a,
+                                 int num_threads)
+{
+    const size_t size = cloud.size();
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t nthreads = std::max((size_t)1, std::min((size_t)num_threads, size));
+
+    if (nthreads == 1)
+    {
+        generate_triplets_range(cloud, tree, triplets, k, n, a, 0, size);
+        return;
+    }
+
+    std::vector<std::vector<triplet>> parts(nthreads);
+    std::vector<std::thread> workers;
+    workers.reserve(nthreads - 1);
+    for (size_t b = 1; b < nthreads; ++b)
+    {
+        workers.emplace_back(generate_triplets_range<Cloud>,
+                             std::cref(cloud),
+                             std::cref(tree),
+                             std::ref(parts[b]),
+                             k,
+                             n,
+                             a,
+                             size * b / nthreads,
+                             size * (b + 1) / nthreads);
+    }
+    generate_triplets_range(cloud, tree, parts[0], k, n, a, 0, size / nthreads);
+    for (size_t b = 0; b < workers.size(); ++b)
+        workers[b].join();
+
+    size_t total = triplets.size();
+    for (size_t b = 0; b < nthreads; ++b)
+        total += parts[b].size();
+    triplets.reserve(total);
+    for (size_t b = 0; b < nthreads; ++b)
+        triplets.insert(triplets.end(), parts[b].begin(), parts[b].end());
+}
+
+void generate_triplets(const PointCloud& cloud,
+                       const PointTree& tree,
+                       std::vector<triplet>& triplets,
+                       size_t k,
+                       size_t n,
+                       double a,
+                       int num_threads)
+{
+    generate_triplets_of(cloud, tree, triplets, k, n, a, num_threads);
+}
+
+void generate_triplets(const PointArrays& cloud,
+                       const PointTree& tree,
+                       std::vector<triplet>& triplets,
+                       size_t k,
+                       size_t n,
+                       double a,
+                       int num_threads)
+{
+    generate_triplets_of(cloud, tree, triplets, k, n, a, num_threads);
+}
+
+// copy of the centers and directions of *triplets*
+TripletArrays::TripletArrays(const std::vector<triplet>& triplets)
+{
+    const size_t n = triplets.size();
+    cx.resize(n);
+    cy.resize(n);
+    cz.resize(n);
+    ux.resize(n);
+    uy.resize(n);
+    uz.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        cx[i] = triplets[i].center.x;
+        cy[i] = triplets[i].center.y;
+        cz[i] = triplets[i].center.z;
+        ux[i] = triplets[i].direction.x;
+        uy[i] = triplets[i].direction.y;
+        uz[i] = triplets[i].direction.z;
+    }
+}
+
 // initialization of scale factor for triplet dissimilarity
 ScaleTripletMetric::ScaleTripletMetric(double s) { this->scale = s; }
 
@@ -136,3 +247,44 @@ double ScaleTripletMetric::operator()(const triplet& lhs, const triplet& rhs)
                 std::fabs(std::tan(std::acos(anglecos))));
     }
 }
+
+// same dissimilarity over a row of pairs, without branches in the loop
+// so that it can be vectorized; |tan(acos(c))| = sqrt(1 - c^2) / |c|
+void ScaleTripletMetric::operator()(const TripletArrays& t,
+                                    size_t i,
+                                    size_t first,
+                                    size_t last,
+                                    double* result) const
+{
+    const double cx = t.cx[i], cy = t.cy[i], cz = t.cz[i];
+    const double ux = t.ux[i], uy = t.uy[i], uz = t.uz[i];
+    const double inv_scale = 1.0 / this->scale;
+    const double* rcx = &t.cx[0];
+    const double* rcy = &t.cy[0];
+    const double* rcz = &t.cz[0];
+    const double* rux = &t.ux[0];
+    const double* ruy = &t.uy[0];
+    const double* ruz = &t.uz[0];
+
+    for (size_t j = first; j < last; ++j)
+    {
+        // center difference and its projections on both directions
+        const double dx = rcx[j] - cx, dy = rcy[j] - cy, dz = rcz[j] - cz;
+        const double pl = dx * ux + dy * uy + dz * uz;
+        const double pr = dx * rux[j] + dy * ruy[j] + dz * ruz[j];
+        // perpendicular parts
+        const double ax = dx - pl * ux, ay = dy - pl * uy, az = dz - pl * uz;
+        const double bx = dx - pr * rux[j], by = dy - pr * ruy[j], bz = dz - pr * ruz[j];
+        const double perpendicularDistanceA = ax * ax + ay * ay + az * az;
+        const double perpendicularDistanceB = bx * bx + by * by + bz * bz;
+
+        double anglecos = ux * rux[j] + uy * ruy[j] + uz * ruz[j];
+        anglecos = anglecos > 1.0 ? 1.0 : (anglecos < -1.0 ? -1.0 : anglecos);
+        const double abscos = std::fabs(anglecos);
+        const double tangent = std::sqrt(1.0 - anglecos * anglecos) / (abscos < 1.0e-8 ? 1.0e-8 : abscos);
+        const double perpendicular =
+            perpendicularDistanceA > perpendicularDistanceB ? perpendicularDistanceA : perpendicularDistanceB;
+        const double distance = std::sqrt(perpendicular) * inv_scale + tangent;
+        result[j - first] = abscos < 1.0e-8 ? 1.0e+8 : distance;
+    }
+}
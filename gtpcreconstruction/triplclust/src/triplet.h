@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "pointcloud.h"
+#include "pointtree.h"
 
 // triplet of three points
 struct triplet
@@ -28,6 +29,16 @@ struct triplet
     friend bool operator<(const triplet& t1, const triplet& t2) { return (t1.error < t2.error); };
 };
 
+// centers and directions of triplets as separate arrays, for
+// computing the dissimilarity of many pairs at once
+struct TripletArrays
+{
+    std::vector<double> cx, cy, cz; // centers
+    std::vector<double> ux, uy, uz; // directions
+    TripletArrays(const std::vector<triplet>& triplets);
+    size_t size() const { return cx.size(); }
+};
+
 // dissimilarity for triplets.
 // scale is an external scale factor.
 class ScaleTripletMetric
@@ -38,8 +49,27 @@ class ScaleTripletMetric
   public:
     ScaleTripletMetric(double s);
     double operator()(const triplet& lhs, const triplet& rhs);
+    // dissimilarities of triplet i to the triplets first..last-1,
+    // saved in result[0..last-first-1]
+    void operator()(const TripletArrays& t, size_t i, size_t first, size_t last, double* result) const;
 };
 
-// generates triplets from PointCloud
-void generate_triplets(const PointCloud& cloud, std::vector<triplet>& triplets, size_t k, size_t n, double a);
+// generates triplets from PointCloud, with num_threads threads (0 for all hardware threads)
+void generate_triplets(
+    const PointCloud& cloud, std::vector<triplet>& triplets, size_t k, size_t n, double a, int num_threads = 1);
+// same with the kd-tree *tree* built over *cloud*
+void generate_triplets(const PointCloud& cloud,
+                       const PointTree& tree,
+                       std::vector<triplet>& triplets,
+                       size_t k,
+                       size_t n,
+                       double a,
+                       int num_threads = 1);
+void generate_triplets(const PointArrays& cloud,
+                       const PointTree& tree,
+                       std::vector<triplet>& triplets,
+                       size_t k,
+                       size_t n,
+                       double a,
+                       int num_threads = 1);
 #endif
@@ -1,118 +0,0 @@
-# CMAKE generated file: DO NOT EDIT!
-# Generated by "Unix Makefiles" Generator, CMake Version 3.13
-
-# The generator used is:
-set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
-
-# The top level Makefile was generated from the following files:
-set(CMAKE_MAKEFILE_DEPENDS
-  "CMakeCache.txt"
-  "../CMakeLists.txt"
-  "CMakeFiles/3.13.4/CMakeCCompiler.cmake"
-  "CMakeFiles/3.13.4/CMakeCXXCompiler.cmake"
-  "CMakeFiles/3.13.4/CMakeSystem.cmake"
-  "CMakeFiles/feature_tests.c"
-  "CMakeFiles/feature_tests.cxx"
-  "/usr/share/cmake-3.13/Modules/CMakeCCompiler.cmake.in"
-  "/usr/share/cmake-3.13/Modules/CMakeCCompilerABI.c"
-  "/usr/share/cmake-3.13/Modules/CMakeCInformation.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeCXXCompiler.cmake.in"
-  "/usr/share/cmake-3.13/Modules/CMakeCXXCompilerABI.cpp"
-  "/usr/share/cmake-3.13/Modules/CMakeCXXInformation.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeCommonLanguageInclude.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeCompilerIdDetection.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCXXCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCompileFeatures.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCompilerABI.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineCompilerId.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeDetermineSystem.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeFindBinUtils.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeGenericSystem.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeInitializeConfigs.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeLanguageInformation.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeParseImplicitLinkInfo.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeSystem.cmake.in"
-  "/usr/share/cmake-3.13/Modules/CMakeSystemSpecificInformation.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeSystemSpecificInitialize.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeTestCCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeTestCXXCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeTestCompilerCommon.cmake"
-  "/usr/share/cmake-3.13/Modules/CMakeUnixFindMake.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/ADSP-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/ARMCC-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/AppleClang-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Borland-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Bruce-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Clang-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Clang-DetermineCompilerInternal.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Comeau-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Compaq-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Compaq-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Cray-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Embarcadero-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Fujitsu-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GHS-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-C-FeatureTests.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-C.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-CXX-FeatureTests.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-CXX.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU-FindBinUtils.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/GNU.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/HP-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/HP-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/IAR-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/IBMCPP-C-DetermineVersionInternal.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/IBMCPP-CXX-DetermineVersionInternal.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Intel-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/MIPSpro-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/MSVC-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/NVIDIA-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/OpenWatcom-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/PGI-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/PathScale-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/SCO-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/SDCC-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/SunPro-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/SunPro-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/TI-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/TinyCC-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/VisualAge-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/VisualAge-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/Watcom-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/XL-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/XL-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/zOS-C-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Compiler/zOS-CXX-DetermineCompiler.cmake"
-  "/usr/share/cmake-3.13/Modules/Internal/FeatureTesting.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/Linux-Determine-CXX.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/Linux-GNU-C.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/Linux-GNU-CXX.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/Linux-GNU.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/Linux.cmake"
-  "/usr/share/cmake-3.13/Modules/Platform/UnixPaths.cmake"
-  )
-
-# The corresponding makefile is:
-set(CMAKE_MAKEFILE_OUTPUTS
-  "Makefile"
-  "CMakeFiles/cmake.check_cache"
-  )
-
-# Byproducts of CMake generate step:
-set(CMAKE_MAKEFILE_PRODUCTS
-  "CMakeFiles/3.13.4/CMakeSystem.cmake"
-  "CMakeFiles/3.13.4/CMakeCCompiler.cmake"
-  "CMakeFiles/3.13.4/CMakeCXXCompiler.cmake"
-  "CMakeFiles/3.13.4/CMakeCCompiler.cmake"
-  "CMakeFiles/3.13.4/CMakeCXXCompiler.cmake"
-  "CMakeFiles/CMakeDirectoryInformation.cmake"
-  )
-
-# Dependency information for all targets:
-set(CMAKE_DEPEND_INFO_FILES
-  )
@@ -20,7 +20,9 @@ root -b run_proj.C<<EOF
 EOF
 echo -e "\n----------------Processing the projected tracks with the AGET electronics!----------------\n"
 cd ../electronics
-. run_ele.sh
+root -b run_ele.C<<EOF
+.q
+EOF
 cd ../../..
 echo -e "\n----------------End of the simulation!----------------\n"
 fi